@@ -0,0 +1,4 @@
+# Package configuration for find_package(lwmem)
+include(CMakeFindDependencyMacro)
+find_dependency(Threads)
+include("${CMAKE_CURRENT_LIST_DIR}/lwmem-targets.cmake")
@@ -38,6 +38,7 @@ extern "C" {
 #endif
 
 #include "string.h"
+#include "stdint.h"
 
 /**
  * \defgroup        LWMEM Lightweight dynamic memory manager
@@ -55,6 +56,69 @@ extern "C" {
  * \note            Modification of this macro must be done in header and source file aswell
  */
 #define LWMEM_PREF(x)                     lwmem_ ## x
+
+/**
+ * \brief           Enables `1` or disables `0` thread safety of memory manager and its sub-allocators
+ *
+ * When enabled, system functions from \ref lwmem_sys.h must be implemented by system port
+ */
+#ifndef LWMEM_THREAD_SAFE
+#define LWMEM_THREAD_SAFE                 0
+#endif /* LWMEM_THREAD_SAFE */
+
+/**
+ * \brief           Enables `1` or disables `0` NUMA node-local allocation policy
+ *
+ * When enabled, allocation functions prefer regions on NUMA node of calling thread,
+ * and fall back to regions on other nodes when local regions are full.
+ * Current node is reported by system function from \ref lwmem_sys.h
+ */
+#ifndef LWMEM_NUMA
+#define LWMEM_NUMA                        0
+#endif /* LWMEM_NUMA */
+
+/**
+ * \brief           Enables `1` or disables `0` returning memory of unused free blocks to operating system
+ *
+ * Pages inside free blocks, which stay unused for several calls of \ref lwmem_purge function,
+ * are released with `madvise`, while block headers stay intact.
+ * It is used when regions are memory mappings of operating system.
+ *
+ * \note            Available on Linux only
+ */
+#ifndef LWMEM_PURGE
+#define LWMEM_PURGE                       0
+#endif /* LWMEM_PURGE */
+
+/**
+ * \brief           Enables `1` or disables `0` allocation counters in \ref lwmem_get_stats
+ *
+ * Counters are kept in per-thread slots, each in its own cache line,
+ * and are summed only when statistics are read
+ */
+#ifndef LWMEM_STATS
+#define LWMEM_STATS                       0
+#endif /* LWMEM_STATS */
+
+/**
+ * \brief           Enables `1` or disables `0` allocation size histogram
+ *
+ * Requested sizes are counted in log-linear buckets, with `4` buckets per doubling of size.
+ * Counters are updated while memory manager is already protected
+ */
+#ifndef LWMEM_HISTOGRAM
+#define LWMEM_HISTOGRAM                   0
+#endif /* LWMEM_HISTOGRAM */
+
+/**
+ * \brief           Enables `1` or disables `0` latency histograms of allocator operations
+ *
+ * Public functions are timed with processor cycle counter, and number of free list nodes
+ * visited by each search is counted, to correlate latency with length of free list
+ */
+#ifndef LWMEM_LATENCY
+#define LWMEM_LATENCY                     0
+#endif /* LWMEM_LATENCY */
 /* --- Memory unique part ends --- */
 
 /**
@@ -63,15 +127,139 @@ extern "C" {
 typedef struct {   
     void* start_addr;                           /*!< Region start address */
     size_t size;                                /*!< Size of region in units of bytes */
+    unsigned int node;                          /*!< NUMA node of region memory, `0` for systems without NUMA */
 } LWMEM_PREF(region_t);
 
+/**
+ * \brief           Block information, reported by \ref lwmem_walk function
+ */
+typedef struct {
+    void* ptr;                                  /*!< Application memory address of block */
+    size_t size;                                /*!< Usable size of block in units of bytes */
+    size_t region;                              /*!< Index of region block belongs to */
+    unsigned char allocated;                    /*!< Set to `1` when block is allocated, `0` when it is free */
+} LWMEM_PREF(block_info_t);
+
+/**
+ * \brief           Callback function for \ref lwmem_walk
+ * \param[in]       info: Information of visited block
+ * \param[in]       arg: Custom user argument
+ * \return          `1` to continue walk, `0` to stop it
+ */
+typedef unsigned char (*LWMEM_PREF(walk_fn))(const LWMEM_PREF(block_info_t)* info, void* arg);
+
+/**
+ * \brief           Memory manager statistics
+ */
+typedef struct {
+    size_t mem_size_bytes;                      /*!< Size of all regions used for allocation */
+    size_t mem_available_bytes;                 /*!< Size of free memory, including meta data of free blocks */
+    size_t dirty_bytes;                         /*!< Size of free memory backed by physical pages.
+                                                    Upper bound, see `clean_bytes` */
+    size_t clean_bytes;                         /*!< Size of free memory returned to operating system with \ref lwmem_purge.
+                                                    Exact while purged blocks are split or merged as a whole.
+                                                    Lower bound when partly purged block is split,
+                                                    as only number of clean bytes is kept per free block */
+    size_t alloc_count;                         /*!< Number of successful allocations, `0` when \ref LWMEM_STATS is disabled */
+    size_t free_count;                          /*!< Number of freed blocks, `0` when \ref LWMEM_STATS is disabled */
+    size_t realloc_count;                       /*!< Number of successful reallocations, `0` when \ref LWMEM_STATS is disabled */
+    size_t failed_count;                        /*!< Number of failed allocations and reallocations, `0` when \ref LWMEM_STATS is disabled */
+} LWMEM_PREF(stats_t);
+
+/**
+ * \brief           Allocation size histogram bucket, reported by \ref lwmem_histogram function
+ */
+typedef struct {
+    size_t size;                                /*!< Biggest size in bucket, in units of bytes */
+    size_t requests;                            /*!< Number of allocation requests with size in bucket */
+    size_t allocated;                           /*!< Number of allocated blocks with usable size in bucket */
+    size_t freed;                               /*!< Number of freed blocks with usable size in bucket */
+    size_t live;                                /*!< Number of blocks currently allocated */
+} LWMEM_PREF(hist_bucket_t);
+
+/**
+ * \brief           Output format of dump functions
+ */
+typedef enum {
+    LWMEM_DUMP_TEXT,                            /*!< Human readable table */
+    LWMEM_DUMP_JSON,                            /*!< JSON object */
+} LWMEM_PREF(dump_format_t);
+
+/**
+ * \brief           Allocator operation, measured with \ref LWMEM_LATENCY
+ */
+typedef enum {
+    LWMEM_OP_MALLOC,                            /*!< \ref lwmem_malloc function */
+    LWMEM_OP_MALLOC_ALIGNED,                    /*!< \ref lwmem_malloc_aligned function */
+    LWMEM_OP_MALLOC_NODE,                       /*!< \ref lwmem_malloc_node function */
+    LWMEM_OP_CALLOC,                            /*!< \ref lwmem_calloc function */
+    LWMEM_OP_REALLOC,                           /*!< \ref lwmem_realloc function */
+    LWMEM_OP_EXPAND_IN_PLACE,                   /*!< \ref lwmem_expand_in_place function */
+    LWMEM_OP_SHRINK_IN_PLACE,                   /*!< \ref lwmem_shrink_in_place function */
+    LWMEM_OP_FREE,                              /*!< \ref lwmem_free function */
+    LWMEM_OP_SEARCH,                            /*!< Free list search of allocation, measured in visited nodes instead of cycles */
+    LWMEM_OP_COUNT,                             /*!< Number of operations */
+} LWMEM_PREF(op_t);
+
+/**
+ * \brief           Latency summary of operation, reported by \ref lwmem_latency function
+ */
+typedef struct {
+    uint64_t count;                             /*!< Number of measurements */
+    uint64_t mean;                              /*!< Mean value */
+    uint64_t p50;                               /*!< Median value */
+    uint64_t p90;                               /*!< Value at `90` percentile */
+    uint64_t p99;                               /*!< Value at `99` percentile */
+    uint64_t p999;                              /*!< Value at `99.9` percentile */
+    uint64_t max;                               /*!< Biggest value */
+} LWMEM_PREF(latency_t);
+
+/**
+ * \brief           Consistency check mode for \ref lwmem_check function
+ */
+typedef enum {
+    LWMEM_CHECK_FAST,                           /*!< Check list of free blocks only */
+    LWMEM_CHECK_THOROUGH,                       /*!< Check list of free blocks and all blocks of all regions */
+} LWMEM_PREF(check_mode_t);
+
 size_t          LWMEM_PREF(assignmem)(const LWMEM_PREF(region_t)* regions, const size_t len);
 void *          LWMEM_PREF(malloc)(const size_t size);
+void *          LWMEM_PREF(malloc_at_least)(const size_t size, size_t* const actual);
+void *          LWMEM_PREF(malloc_aligned)(const size_t alignment, const size_t size);
+void *          LWMEM_PREF(malloc_node)(const size_t size, const unsigned int node);
 void *          LWMEM_PREF(calloc)(const size_t nitems, const size_t size);
 void *          LWMEM_PREF(realloc)(void* const ptr, const size_t size);
 unsigned char   LWMEM_PREF(realloc_s)(void** const ptr, const size_t size);
+unsigned char   LWMEM_PREF(expand_in_place)(void* const ptr, const size_t size);
+unsigned char   LWMEM_PREF(shrink_in_place)(void* const ptr, const size_t size);
 void            LWMEM_PREF(free)(void* const ptr);
 void            LWMEM_PREF(free_s)(void** const ptr);
+size_t          LWMEM_PREF(usable_size)(void* const ptr);
+size_t          LWMEM_PREF(walk)(LWMEM_PREF(walk_fn) fn, void* const arg);
+unsigned char   LWMEM_PREF(check)(const LWMEM_PREF(check_mode_t) mode);
+size_t          LWMEM_PREF(snapshot)(void* const out_buf, const size_t size);
+unsigned char   LWMEM_PREF(restore)(const void* const in_buf, const size_t size);
+void            LWMEM_PREF(get_stats)(LWMEM_PREF(stats_t)* const stats);
+
+#if LWMEM_PURGE || __DOXYGEN__
+size_t          LWMEM_PREF(purge)(const unsigned char all);
+#endif /* LWMEM_PURGE || __DOXYGEN__ */
+
+#if LWMEM_HISTOGRAM || __DOXYGEN__
+size_t          LWMEM_PREF(histogram)(LWMEM_PREF(hist_bucket_t)* const buckets, const size_t len);
+size_t          LWMEM_PREF(histogram_dump)(char* const buf, const size_t size, const LWMEM_PREF(dump_format_t) format);
+#endif /* LWMEM_HISTOGRAM || __DOXYGEN__ */
+
+#if LWMEM_LATENCY || __DOXYGEN__
+void            LWMEM_PREF(latency)(const LWMEM_PREF(op_t) op, LWMEM_PREF(latency_t)* const latency);
+void            LWMEM_PREF(latency_reset)(void);
+size_t          LWMEM_PREF(latency_dump)(char* const buf, const size_t size, const LWMEM_PREF(dump_format_t) format);
+#endif /* LWMEM_LATENCY || __DOXYGEN__ */
+
+#if LWMEM_THREAD_SAFE || __DOXYGEN__
+void            LWMEM_PREF(lock)(void);
+void            LWMEM_PREF(unlock)(void);
+#endif /* LWMEM_THREAD_SAFE || __DOXYGEN__ */
 
 #undef LWMEM_PREF
 
@@ -0,0 +1,351 @@
+/**
+ * \file            lwmem.hpp
+ * \brief           C++ interface for lightweight dynamic memory manager
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#ifndef LWMEM_HDR_HPP
+#define LWMEM_HDR_HPP
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "lwmem/lwmem.h"
+#include "lwmem/lwmem_arena.h"
+#include "lwmem/lwmem_heap.hpp"
+
+/**
+ * \defgroup        LWMEM_CPP C++ interface
+ * \brief           C++ interface, requires C++17
+ * \ingroup         LWMEM
+ * \{
+ */
+
+namespace lwmem {
+
+/**
+ * \brief           Allocator on top of memory manager heap, for standard library containers
+ *
+ * Allocator is stateless and all instances compare equal,
+ * memory allocated by one instance may be deallocated by any other
+ *
+ * \tparam          T: Type of allocated objects
+ */
+template<typename T>
+class allocator {
+  public:
+    using value_type = T;
+
+    template<typename U>
+    struct rebind {
+        using other = allocator<U>;
+    };
+
+    allocator() noexcept = default;
+
+    template<typename U>
+    allocator(const allocator<U>&) noexcept {}
+
+    /**
+     * \brief       Allocate memory for `n` objects, aligned for type `T`
+     * \param[in]   n: Number of objects
+     * \return      Pointer to allocated memory
+     */
+    T*
+    allocate(std::size_t n) {
+        void* ptr;
+
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        if ((ptr = lwmem_malloc_aligned(alignof(T), n > 0 ? n * sizeof(T) : 1)) == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    /**
+     * \brief       Deallocate memory, size is known from block meta data
+     * \param[in]   ptr: Memory previously allocated with \ref allocate
+     */
+    void
+    deallocate(T* ptr, std::size_t) noexcept {
+        lwmem_free(ptr);
+    }
+};
+
+template<typename T, typename U>
+bool
+operator==(const allocator<T>&, const allocator<U>&) noexcept {
+    return true;
+}
+
+template<typename T, typename U>
+bool
+operator!=(const allocator<T>&, const allocator<U>&) noexcept {
+    return false;
+}
+
+/**
+ * \brief           Stateless deleter for objects created with \ref make_unique
+ * \tparam          T: Type of object
+ */
+template<typename T>
+struct deleter {
+    deleter() noexcept = default;
+
+    template<typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    deleter(const deleter<U>&) noexcept {}
+
+    void
+    operator()(T* ptr) const noexcept {
+        if (ptr != nullptr) {
+            ptr->~T();
+            lwmem_free(ptr);
+        }
+    }
+};
+
+/**
+ * \brief           Stateless deleter for arrays created with \ref make_unique
+ * \note            Array elements are not destroyed, elements must be trivially destructible
+ * \tparam          T: Type of array element
+ */
+template<typename T>
+struct deleter<T[]> {
+    static_assert(std::is_trivially_destructible_v<T>, "Array elements must be trivially destructible");
+
+    void
+    operator()(T* ptr) const noexcept {
+        lwmem_free(ptr);
+    }
+};
+
+/**
+ * \brief           Unique pointer to memory on memory manager heap, with the same size as raw pointer
+ * \tparam          T: Type of object or array
+ */
+template<typename T>
+using unique_ptr = std::unique_ptr<T, deleter<T>>;
+
+static_assert(sizeof(unique_ptr<int>) == sizeof(int*), "Deleter must not increase size of unique pointer");
+
+/**
+ * \brief           Create object on memory manager heap
+ * \param[in]       args: Arguments passed to object constructor
+ * \return          Unique pointer owning new object
+ */
+template<typename T, typename... Args>
+std::enable_if_t<!std::is_array_v<T>, unique_ptr<T>>
+make_unique(Args&&... args) {
+    void* const mem = lwmem_malloc_aligned(alignof(T), sizeof(T));
+
+    if (mem == nullptr) {
+        throw std::bad_alloc();
+    }
+    try {
+        return unique_ptr<T>(::new (mem) T(std::forward<Args>(args)...));
+    } catch (...) {
+        lwmem_free(mem);
+        throw;
+    }
+}
+
+/**
+ * \brief           Create value-initialized array on memory manager heap
+ * \param[in]       n: Number of array elements
+ * \return          Unique pointer owning new array
+ */
+template<typename T>
+std::enable_if_t<std::is_array_v<T> && std::extent_v<T> == 0, unique_ptr<T>>
+make_unique(std::size_t n) {
+    using E = std::remove_extent_t<T>;
+    void* mem;
+
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(E)) {
+        throw std::bad_array_new_length();
+    }
+    if ((mem = lwmem_malloc_aligned(alignof(E), n > 0 ? n * sizeof(E) : 1)) == nullptr) {
+        throw std::bad_alloc();
+    }
+    try {
+        for (std::size_t i = 0; i < n; ++i) {
+            ::new (static_cast<E*>(mem) + i) E();
+        }
+    } catch (...) {
+        lwmem_free(mem);                        /* Elements are trivially destructible */
+        throw;
+    }
+    return unique_ptr<T>(static_cast<E*>(mem));
+}
+
+/**
+ * \brief           Base of polymorphic memory resources on top of memory manager heap
+ *
+ * Resources compare equal when they allocate from the same heap, regardless of their lock type
+ */
+class heap_resource_base : public std::pmr::memory_resource {
+  protected:
+    bool
+    do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return dynamic_cast<const heap_resource_base*>(&other) != nullptr;  /* There is only one heap */
+    }
+};
+
+/**
+ * \brief           Polymorphic memory resource on top of memory manager heap
+ *
+ * All instances allocate from the same heap and compare equal.
+ * Synchronized variant protects heap with one mutex, shared by all its instances.
+ * It is only needed when library is built with \ref LWMEM_THREAD_SAFE disabled
+ *
+ * \tparam          Mutex: Lock type to protect heap, \ref null_mutex for no protection
+ */
+template<typename Mutex>
+class basic_memory_resource : public heap_resource_base {
+  protected:
+    void*
+    do_allocate(std::size_t bytes, std::size_t alignment) override {
+        void* ptr;
+        {
+            std::lock_guard<Mutex> lock(mutex());
+            ptr = lwmem_malloc_aligned(alignment, bytes > 0 ? bytes : 1);
+        }
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+
+    void
+    do_deallocate(void* ptr, std::size_t, std::size_t) override {
+        std::lock_guard<Mutex> lock(mutex());
+        lwmem_free(ptr);                        /* Block size is known from its meta data */
+    }
+
+  private:
+    static Mutex&
+    mutex() noexcept {
+        static Mutex m;
+        return m;
+    }
+};
+
+/**
+ * \brief           Polymorphic memory resource on top of arena allocator
+ *
+ * Resource owns arena. Memory is released all at once with \ref release or when resource is destroyed
+ *
+ * \tparam          Mutex: Lock type to protect arena, \ref null_mutex for no protection
+ */
+template<typename Mutex>
+class basic_arena_resource : public std::pmr::memory_resource {
+  public:
+    /**
+     * \brief       Create arena resource
+     * \param[in]   size: Arena size, see \ref lwmem_arena_create
+     */
+    explicit basic_arena_resource(std::size_t size) : arena_(lwmem_arena_create(size)) {
+        if (arena_ == nullptr) {
+            throw std::bad_alloc();
+        }
+    }
+
+    basic_arena_resource(const basic_arena_resource&) = delete;
+    basic_arena_resource& operator=(const basic_arena_resource&) = delete;
+
+    ~basic_arena_resource() override {
+        lwmem_arena_destroy(arena_);
+    }
+
+    /**
+     * \brief       Release all allocations of the resource at once
+     */
+    void
+    release() noexcept {
+        std::lock_guard<Mutex> lock(mutex_);
+        lwmem_arena_reset(arena_);
+    }
+
+  protected:
+    void*
+    do_allocate(std::size_t bytes, std::size_t alignment) override {
+        void* ptr;
+        {
+            std::lock_guard<Mutex> lock(mutex_);
+            ptr = lwmem_arena_alloc(arena_, bytes > 0 ? bytes : 1, alignment);
+        }
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+
+    void
+    do_deallocate(void*, std::size_t, std::size_t) override {
+        /* Memory is released with arena only */
+    }
+
+    bool
+    do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+  private:
+    lwmem_arena_t* arena_;                      /*!< Arena handle */
+    Mutex mutex_;                               /*!< Mutex to protect arena */
+};
+
+using memory_resource = basic_memory_resource<null_mutex>;
+using synchronized_memory_resource = basic_memory_resource<std::mutex>;
+using arena_resource = basic_arena_resource<null_mutex>;
+using synchronized_arena_resource = basic_arena_resource<std::mutex>;
+
+/**
+ * \brief           Get memory resource on top of memory manager heap
+ * \return          Pointer to resource instance
+ */
+inline memory_resource*
+heap_resource() noexcept {
+    static memory_resource r;
+    return &r;
+}
+
+} /* namespace lwmem */
+
+/**
+ * \}
+ */
+
+#endif /* LWMEM_HDR_HPP */
@@ -0,0 +1,82 @@
+/**
+ * \file            lwmem_arena.h
+ * \brief           Arena allocator on top of lightweight dynamic memory manager
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#ifndef LWMEM_HDR_ARENA_H
+#define LWMEM_HDR_ARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lwmem/lwmem.h"
+
+/**
+ * \defgroup        LWMEM_ARENA Arena allocator
+ * \brief           Pointer-bump allocator with memory taken from heap in big chunks
+ * \ingroup         LWMEM
+ *
+ * Arena serves many small allocations, released all together at once
+ * with \ref lwmem_arena_reset or \ref lwmem_arena_destroy functions.
+ * Individual allocations cannot be freed.
+ *
+ * \{
+ */
+
+/* --- Memory unique part starts --- */
+/**
+ * \brief           Memory function/typedef prefix string
+ * \note            Modification of this macro must be done in \ref lwmem.h file aswell
+ */
+#define LWMEM_PREF(x)                     lwmem_ ## x
+/* --- Memory unique part ends --- */
+
+/**
+ * \brief           Arena handle
+ */
+typedef struct LWMEM_PREF(arena) LWMEM_PREF(arena_t);
+
+LWMEM_PREF(arena_t)*    LWMEM_PREF(arena_create)(const size_t size);
+void *                  LWMEM_PREF(arena_alloc)(LWMEM_PREF(arena_t)* const arena, const size_t size, const size_t alignment);
+void                    LWMEM_PREF(arena_reset)(LWMEM_PREF(arena_t)* const arena);
+void                    LWMEM_PREF(arena_destroy)(LWMEM_PREF(arena_t)* const arena);
+
+#undef LWMEM_PREF
+
+/**
+ * \}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWMEM_HDR_ARENA_H */
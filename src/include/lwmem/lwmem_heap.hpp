@@ -0,0 +1,469 @@
+/**
+ * \file            lwmem_heap.hpp
+ * \brief           Compile-time configurable memory manager heap for C++
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#ifndef LWMEM_HDR_HEAP_HPP
+#define LWMEM_HDR_HEAP_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <type_traits>
+
+/**
+ * \defgroup        LWMEM_HEAP_CPP C++ template heap
+ * \brief           Header-only heap with configuration resolved at compile time
+ * \ingroup         LWMEM_CPP
+ *
+ * Heap uses the same algorithm as C implementation: address ordered list of free blocks,
+ * with free blocks merged on free, in user assigned memory regions.
+ * Configuration is given with template parameters instead of macros, therefore each heap type
+ * gets specialized code, with metadata sizes and size class table computed at compile time.
+ *
+ * \{
+ */
+
+namespace lwmem {
+
+/**
+ * \brief           Lock type with no effect, used by unsynchronized variants
+ */
+struct null_mutex {
+    void lock() noexcept {}
+    void unlock() noexcept {}
+};
+
+/**
+ * \brief           Fit policy: use first free block big enough for allocation
+ */
+struct first_fit {
+    static constexpr bool is_best_fit = false;  /*!< Search for smallest suitable block */
+    static constexpr bool use_size_classes = false; /*!< Round allocation size up to size class */
+};
+
+/**
+ * \brief           Fit policy: use smallest free block big enough for allocation
+ */
+struct best_fit {
+    static constexpr bool is_best_fit = true;   /*!< Search for smallest suitable block */
+    static constexpr bool use_size_classes = false; /*!< Round allocation size up to size class */
+};
+
+/**
+ * \brief           Fit policy: round allocation size up to size class and use first free block
+ *
+ * Freed blocks of common sizes are reused exactly, which reduces fragmentation
+ */
+struct class_fit {
+    static constexpr bool is_best_fit = false;  /*!< Search for smallest suitable block */
+    static constexpr bool use_size_classes = true;  /*!< Round allocation size up to size class */
+};
+
+/**
+ * \brief           Header format: pointer to next free block and block size of `size_t` type
+ */
+struct pointer_header {
+    /**
+     * \brief       Block meta data
+     */
+    struct block {
+        block* next;                            /*!< Next free block */
+        std::size_t size;                       /*!< Block size, MSB set when allocated */
+    };
+
+    using size_type = std::size_t;
+
+    static block*
+    get_next(const block* b, unsigned char*) noexcept {
+        return b->next;
+    }
+
+    static void
+    set_next(block* b, block* next, unsigned char*) noexcept {
+        b->next = next;
+    }
+
+    static void
+    set_alloc_mark(block* b) noexcept {
+        b->next = reinterpret_cast<block*>(static_cast<std::uintptr_t>(0xDEADBEEF));
+    }
+
+    static bool
+    has_alloc_mark(const block* b) noexcept {
+        return b->next == reinterpret_cast<block*>(static_cast<std::uintptr_t>(0xDEADBEEF));
+    }
+};
+
+/**
+ * \brief           Header format: 32-bit offset of next free block and 32-bit block size
+ *
+ * Header has half of the size of \ref pointer_header on 64-bit systems,
+ * but all regions must be within `2 GB` of the first region
+ */
+struct offset_header {
+    /**
+     * \brief       Block meta data
+     */
+    struct block {
+        std::uint32_t next;                     /*!< Offset of next free block from first region plus `1`, `0` for none */
+        std::uint32_t size;                     /*!< Block size, MSB set when allocated */
+    };
+
+    using size_type = std::uint32_t;
+
+    static block*
+    get_next(const block* b, unsigned char* base) noexcept {
+        return b->next == 0 ? nullptr : reinterpret_cast<block*>(base + (b->next - 1));
+    }
+
+    static void
+    set_next(block* b, block* next, unsigned char* base) noexcept {
+        b->next = next == nullptr ? 0 : static_cast<std::uint32_t>(reinterpret_cast<unsigned char*>(next) - base + 1);
+    }
+
+    static void
+    set_alloc_mark(block* b) noexcept {
+        b->next = 0xDEADBEEF;                   /* Odd value minus 1 is never aligned block offset */
+    }
+
+    static bool
+    has_alloc_mark(const block* b) noexcept {
+        return b->next == 0xDEADBEEF;
+    }
+};
+
+/**
+ * \brief           Memory manager heap with compile-time configuration
+ * \tparam          Align: Alignment of memory address and size, power of `2`
+ * \tparam          FitPolicy: Free block search policy, \ref first_fit, \ref best_fit or \ref class_fit
+ * \tparam          HeaderFormat: Block meta data format, \ref pointer_header or \ref offset_header
+ * \tparam          LockPolicy: Lock type to protect heap, \ref null_mutex for no protection
+ */
+template<std::size_t Align = alignof(std::max_align_t), typename FitPolicy = first_fit,
+         typename HeaderFormat = pointer_header, typename LockPolicy = null_mutex>
+class heap {
+    using header = HeaderFormat;
+    using block = typename header::block;
+
+  public:
+    using size_type = typename header::size_type;
+
+    static_assert(Align > 0 && (Align & (Align - 1)) == 0, "Alignment must be power of 2");
+    static_assert(Align >= alignof(block), "Alignment must not be smaller than alignment of block meta data");
+    static_assert(Align > 1 || !std::is_same_v<header, offset_header>, "Offset header requires alignment of at least 2");
+
+    /**
+     * \brief       Align input value up to \ref alignment
+     */
+    static constexpr std::size_t
+    align_up(std::size_t x) noexcept {
+        return (x + (Align - 1)) & ~(Align - 1);
+    }
+
+    static constexpr std::size_t alignment = Align;  /*!< Alignment of memory address and size */
+    static constexpr std::size_t meta_size = align_up(sizeof(block)); /*!< Size of block meta data */
+    static constexpr std::size_t min_block_size = meta_size; /*!< Minimal size of new free block */
+    static constexpr size_type alloc_bit = static_cast<size_type>(size_type(1) << (std::numeric_limits<size_type>::digits - 1)); /*!< Allocated block indication */
+
+    static constexpr std::size_t size_class_linear = 8; /*!< Number of size classes with linear step of \ref alignment */
+    static constexpr std::size_t size_class_per_double = 4; /*!< Number of size classes per doubling of size */
+    static constexpr std::size_t size_class_doubles = 10; /*!< Number of size doublings covered by size classes */
+    static constexpr std::size_t size_class_count = size_class_linear + size_class_per_double * size_class_doubles;
+
+    /**
+     * \brief       Table of application sizes of size classes, used by \ref class_fit policy
+     */
+    static constexpr std::array<std::size_t, size_class_count> size_classes = [] {
+        std::array<std::size_t, size_class_count> t{};
+        std::size_t i = 0, p = size_class_linear * Align;
+
+        for (; i < size_class_linear; ++i) {
+            t[i] = (i + 1) * Align;
+        }
+        for (std::size_t d = 0; d < size_class_doubles; ++d, p *= 2) {
+            for (std::size_t k = 1; k <= size_class_per_double; ++k) {
+                t[i++] = p + k * (p / size_class_per_double);
+            }
+        }
+        return t;
+    }();
+
+    heap() noexcept {
+        start_.size = 0;
+        header::set_next(&start_, nullptr, nullptr);
+    }
+
+    heap(const heap&) = delete;
+    heap& operator=(const heap&) = delete;
+
+    /**
+     * \brief       Assign memory region to the heap
+     * \param[in]   mem: Region start address. Region must be higher in address space than previous one
+     * \param[in]   size: Region size in units of bytes
+     * \return      `true` on success, `false` otherwise
+     */
+    bool
+    add_region(void* mem, std::size_t size) noexcept {
+        std::lock_guard<LockPolicy> lock(mutex_);
+        unsigned char* start = static_cast<unsigned char*>(mem);
+        std::size_t pad = (Align - (reinterpret_cast<std::uintptr_t>(start) & (Align - 1))) & (Align - 1);
+        block* first, *prev_end = end_;
+
+        if (mem == nullptr || size <= pad) {
+            return false;
+        }
+        start += pad;
+        size = (size - pad) & ~(Align - 1);
+        if (size < 2 * min_block_size || static_cast<size_type>(size - meta_size) != size - meta_size
+            || ((size - meta_size) & alloc_bit)
+            || (end_ != nullptr && start < reinterpret_cast<unsigned char*>(end_) + meta_size)) {
+            return false;
+        }
+        if (end_ == nullptr) {
+            base_ = start;                      /* First region is base for offsets */
+        }
+        if constexpr (std::is_same_v<header, offset_header>) {
+            if (static_cast<std::size_t>(start + size - base_) >= alloc_bit) {
+                return false;
+            }
+        }
+
+        /* End of region indicator */
+        end_ = reinterpret_cast<block*>(start + size - meta_size);
+        end_->size = 0;
+        header::set_next(end_, nullptr, base_);
+
+        /* First block takes complete region */
+        first = reinterpret_cast<block*>(start);
+        first->size = static_cast<size_type>(size - meta_size);
+        header::set_next(first, end_, base_);
+
+        if (prev_end != nullptr) {
+            header::set_next(prev_end, first, base_);
+        } else {
+            header::set_next(&start_, first, base_);
+        }
+        available_ += first->size;
+        return true;
+    }
+
+    /**
+     * \brief       Allocate memory
+     * \param[in]   size: Number of bytes to allocate
+     * \return      Pointer to allocated memory on success, `nullptr` otherwise
+     */
+    void*
+    allocate(std::size_t size) noexcept {
+        block* prev, *curr;
+        std::size_t final_size;
+
+        if (size == 0 || size > (alloc_bit >> 1)) {
+            return nullptr;
+        }
+        if constexpr (FitPolicy::use_size_classes) {
+            size = class_size(size);
+        }
+        final_size = align_up(size) + meta_size;
+
+        std::lock_guard<LockPolicy> lock(mutex_);
+        if (end_ == nullptr) {
+            return nullptr;
+        }
+        prev = &start_;
+        curr = next(prev);
+        if constexpr (FitPolicy::is_best_fit) {
+            block* best_prev = nullptr;
+            for (;; prev = curr, curr = next(curr)) {
+                if (curr->size >= final_size && (best_prev == nullptr || curr->size < next(best_prev)->size)) {
+                    best_prev = prev;
+                    if (curr->size == final_size) {
+                        break;                  /* Exact fit cannot be improved */
+                    }
+                }
+                if (next(curr) == nullptr || curr == end_) {
+                    break;
+                }
+            }
+            if (best_prev == nullptr) {
+                return nullptr;
+            }
+            prev = best_prev;
+            curr = next(prev);
+        } else {
+            while (curr->size < final_size) {
+                if (next(curr) == nullptr || curr == end_) {
+                    return nullptr;
+                }
+                prev = curr;
+                curr = next(curr);
+            }
+        }
+
+        /* Remove block from free list, split it and set it as allocated */
+        header::set_next(prev, next(curr), base_);
+        available_ -= curr->size;
+        split(curr, final_size);
+        curr->size |= alloc_bit;
+        header::set_alloc_mark(curr);
+        return reinterpret_cast<unsigned char*>(curr) + meta_size;
+    }
+
+    /**
+     * \brief       Free previously allocated memory
+     * \param[in]   ptr: Memory to free. `nullptr` is valid input
+     */
+    void
+    deallocate(void* ptr) noexcept {
+        block* const b = get_block(ptr);
+
+        if (b == nullptr) {
+            return;
+        }
+        std::lock_guard<LockPolicy> lock(mutex_);
+        if ((b->size & alloc_bit) && header::has_alloc_mark(b)) {
+            b->size &= static_cast<size_type>(~alloc_bit);
+            available_ += b->size;
+            insert_free_block(b);
+        }
+    }
+
+    /**
+     * \brief       Get usable size of allocated memory
+     * \param[in]   ptr: Allocated memory
+     * \return      Usable size in units of bytes, `0` if pointer is not valid
+     */
+    std::size_t
+    usable_size(void* ptr) const noexcept {
+        const block* const b = get_block(ptr);
+        if (b != nullptr && (b->size & alloc_bit) && header::has_alloc_mark(b)) {
+            return static_cast<std::size_t>(b->size & static_cast<size_type>(~alloc_bit)) - meta_size;
+        }
+        return 0;
+    }
+
+    /**
+     * \brief       Get number of bytes available for allocation, including meta data of free blocks
+     */
+    std::size_t
+    available() const noexcept {
+        return available_;
+    }
+
+    /**
+     * \brief       Get application size of size class for requested size
+     * \param[in]   size: Requested size
+     * \return      Size class size, or `size` if it is bigger than the biggest class
+     */
+    static constexpr std::size_t
+    class_size(std::size_t size) noexcept {
+        std::size_t lo = 0, hi = size_class_count;
+
+        while (lo < hi) {                       /* Binary search for first class not smaller than size */
+            const std::size_t mid = (lo + hi) / 2;
+            if (size_classes[mid] < size) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo < size_class_count ? size_classes[lo] : size;
+    }
+
+  private:
+    block*
+    next(const block* b) const noexcept {
+        return header::get_next(b, base_);
+    }
+
+    static block*
+    get_block(void* ptr) noexcept {
+        return ptr != nullptr ? reinterpret_cast<block*>(static_cast<unsigned char*>(ptr) - meta_size) : nullptr;
+    }
+
+    /**
+     * \brief       Split too big block and put its remainder to free list
+     */
+    void
+    split(block* b, std::size_t final_size) noexcept {
+        if ((b->size - final_size) >= min_block_size) {
+            block* const nb = reinterpret_cast<block*>(reinterpret_cast<unsigned char*>(b) + final_size);
+            nb->size = static_cast<size_type>(b->size - final_size);
+            b->size = static_cast<size_type>(final_size);
+            available_ += nb->size;
+            insert_free_block(nb);
+        }
+    }
+
+    /**
+     * \brief       Insert free block to address ordered free list and merge it with neighbours
+     */
+    void
+    insert_free_block(block* nb) noexcept {
+        block* prev;
+
+        for (prev = &start_; next(prev) != nullptr && next(prev) < nb; prev = next(prev)) {}
+
+        /* Merge with previous block */
+        if (reinterpret_cast<unsigned char*>(prev) + prev->size == reinterpret_cast<unsigned char*>(nb)) {
+            prev->size = static_cast<size_type>(prev->size + nb->size);
+            nb = prev;
+        }
+
+        /* Merge with next block, but never with end of region indicator */
+        block* const n = next(prev);
+        if (n != nullptr && n->size != 0
+            && reinterpret_cast<unsigned char*>(nb) + nb->size == reinterpret_cast<unsigned char*>(n)) {
+            nb->size = static_cast<size_type>(nb->size + n->size);
+            header::set_next(nb, next(n), base_);
+        } else {
+            header::set_next(nb, n, base_);
+        }
+        if (prev != nb) {
+            header::set_next(prev, nb, base_);
+        }
+    }
+
+    block start_;                               /*!< Dummy start block of free list */
+    block* end_ = nullptr;                      /*!< End of last region indicator */
+    unsigned char* base_ = nullptr;             /*!< Start of first region, base for offsets */
+    std::size_t available_ = 0;                 /*!< Bytes available for allocation */
+    LockPolicy mutex_;                          /*!< Heap lock */
+};
+
+} /* namespace lwmem */
+
+/**
+ * \}
+ */
+
+#endif /* LWMEM_HDR_HEAP_HPP */
@@ -0,0 +1,118 @@
+/**
+ * \file            lwmem_lf.h
+ * \brief           Lock-free size-class allocator on top of lightweight dynamic memory manager
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#ifndef LWMEM_HDR_LF_H
+#define LWMEM_HDR_LF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lwmem/lwmem.h"
+
+/**
+ * \defgroup        LWMEM_LF Lock-free size-class allocator
+ * \brief           Small allocations served from per-class lock-free stacks
+ * \ingroup         LWMEM
+ *
+ * Allocator keeps one Treiber stack of free objects per size class.
+ * Allocation and free from any thread complete with single compare-and-swap operation in common case,
+ * without taking heap mutex. Stack head is pointer packed with version tag,
+ * incremented on every change, to protect against ABA problem.
+ *
+ * Objects are carved from chunks, taken from heap with \ref lwmem_malloc_aligned
+ * and aligned to their size. Size class of object is found in header of its chunk.
+ * Heap is accessed only when stack of size class is empty, and it must be thread safe
+ * when allocator is used from multiple threads.
+ *
+ * Optional thread cache owns chunks it takes from heap and serves allocations without atomic operations.
+ * Memory freed by other threads is pushed to remote-free queue of owner in wait-free manner,
+ * and owner reclaims it in single batch on its next allocation, when its free list is empty.
+ * It is suited for producer/consumer workloads, where memory is freed by other thread than allocated it.
+ *
+ * \{
+ */
+
+/* --- Memory unique part starts --- */
+/**
+ * \brief           Memory function/typedef prefix string
+ * \note            Modification of this macro must be done in \ref lwmem.h file aswell
+ */
+#define LWMEM_PREF(x)                     lwmem_ ## x
+
+/**
+ * \brief           Size of chunk taken from heap when size class is empty, must be power of `2`
+ *
+ * Chunks are aligned to their size, which is used to find chunk of object
+ */
+#ifndef LWMEM_LF_CHUNK_SIZE
+#define LWMEM_LF_CHUNK_SIZE               16384
+#endif /* LWMEM_LF_CHUNK_SIZE */
+/* --- Memory unique part ends --- */
+
+/**
+ * \brief           Maximal size of allocation served by lock-free allocator
+ */
+#define LWMEM_LF_MAX_SIZE                 1024
+
+/**
+ * \brief           Lock-free allocator handle
+ */
+typedef struct LWMEM_PREF(lf) LWMEM_PREF(lf_t);
+
+/**
+ * \brief           Thread cache handle
+ */
+typedef struct LWMEM_PREF(lf_thread) LWMEM_PREF(lf_thread_t);
+
+LWMEM_PREF(lf_t)*   LWMEM_PREF(lf_create)(void);
+void                LWMEM_PREF(lf_destroy)(LWMEM_PREF(lf_t)* const lf);
+void *              LWMEM_PREF(lf_alloc)(LWMEM_PREF(lf_t)* const lf, const size_t size);
+void                LWMEM_PREF(lf_free)(void* const ptr);
+size_t              LWMEM_PREF(lf_usable_size)(void* const ptr);
+
+LWMEM_PREF(lf_thread_t)*    LWMEM_PREF(lf_thread_attach)(LWMEM_PREF(lf_t)* const lf);
+void                        LWMEM_PREF(lf_thread_detach)(LWMEM_PREF(lf_thread_t)* const th);
+void *                      LWMEM_PREF(lf_thread_alloc)(LWMEM_PREF(lf_thread_t)* const th, const size_t size);
+void                        LWMEM_PREF(lf_thread_free)(LWMEM_PREF(lf_thread_t)* const th, void* const ptr);
+
+#undef LWMEM_PREF
+
+/**
+ * \}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWMEM_HDR_LF_H */
@@ -0,0 +1,140 @@
+/**
+ * \file            lwmem_pool.h
+ * \brief           Fixed-size object pool
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#ifndef LWMEM_HDR_POOL_H
+#define LWMEM_HDR_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lwmem/lwmem.h"
+
+/**
+ * \defgroup        LWMEM_POOL Object pool
+ * \brief           Fixed-size object pool with constant time allocation and free
+ * \ingroup         LWMEM
+ *
+ * Pool takes memory from heap in chunks of objects and keeps free objects in intrusive linked list.
+ *
+ * Optional magazine is small per-thread cache of free objects.
+ * Magazine serves allocations and frees without accessing shared pool,
+ * and exchanges objects with pool in batches only when it gets empty or full.
+ *
+ * \{
+ */
+
+/* --- Memory unique part starts --- */
+/**
+ * \brief           Memory function/typedef prefix string
+ * \note            Modification of this macro must be done in \ref lwmem.h file aswell
+ */
+#define LWMEM_PREF(x)                     lwmem_ ## x
+
+/**
+ * \brief           Maximal number of free objects cached in single magazine
+ */
+#ifndef LWMEM_POOL_MAG_SIZE
+#define LWMEM_POOL_MAG_SIZE               32
+#endif /* LWMEM_POOL_MAG_SIZE */
+/* --- Memory unique part ends --- */
+
+/**
+ * \brief           Pool handle
+ */
+typedef struct LWMEM_PREF(pool) LWMEM_PREF(pool_t);
+
+/**
+ * \brief           Magazine of free objects, owned by single thread
+ */
+typedef struct {
+    LWMEM_PREF(pool_t)* pool;                   /*!< Pool magazine belongs to */
+    void* objs[LWMEM_POOL_MAG_SIZE];            /*!< Cached free objects */
+    size_t count;                               /*!< Number of cached objects */
+} LWMEM_PREF(pool_mag_t);
+
+LWMEM_PREF(pool_t)*     LWMEM_PREF(pool_create)(const size_t obj_size, const size_t align, const size_t initial_count);
+void                    LWMEM_PREF(pool_destroy)(LWMEM_PREF(pool_t)* const pool);
+void *                  LWMEM_PREF(pool_alloc)(LWMEM_PREF(pool_t)* const pool);
+void                    LWMEM_PREF(pool_free)(LWMEM_PREF(pool_t)* const pool, void* const ptr);
+
+void                    LWMEM_PREF(pool_mag_init)(LWMEM_PREF(pool_mag_t)* const mag, LWMEM_PREF(pool_t)* const pool);
+void *                  LWMEM_PREF(pool_mag_refill)(LWMEM_PREF(pool_mag_t)* const mag);
+void                    LWMEM_PREF(pool_mag_drain)(LWMEM_PREF(pool_mag_t)* const mag, void* const ptr);
+void                    LWMEM_PREF(pool_mag_flush)(LWMEM_PREF(pool_mag_t)* const mag);
+
+/**
+ * \brief           Allocate object from magazine
+ *
+ * Function is inlined at call site and takes cached object when available.
+ * When magazine is empty, \ref lwmem_pool_mag_refill is called to refill it from pool
+ *
+ * \param[in]       mag: Magazine handle
+ * \return          Pointer to allocated object on success, `NULL` otherwise
+ */
+static inline void *
+LWMEM_PREF(pool_mag_alloc)(LWMEM_PREF(pool_mag_t)* const mag) {
+    if (mag != NULL && mag->count > 0) {
+        return mag->objs[--mag->count];
+    }
+    return LWMEM_PREF(pool_mag_refill)(mag);
+}
+
+/**
+ * \brief           Return object to magazine
+ *
+ * Function is inlined at call site and caches object when magazine is not full.
+ * When magazine is full, \ref lwmem_pool_mag_drain is called to return objects to pool
+ *
+ * \param[in]       mag: Magazine handle
+ * \param[in]       ptr: Object previously allocated from the same pool. `NULL` pointer is valid input
+ */
+static inline void
+LWMEM_PREF(pool_mag_free)(LWMEM_PREF(pool_mag_t)* const mag, void* const ptr) {
+    if (mag != NULL && mag->pool != NULL && ptr != NULL && mag->count < LWMEM_POOL_MAG_SIZE) {
+        mag->objs[mag->count++] = ptr;
+        return;
+    }
+    LWMEM_PREF(pool_mag_drain)(mag, ptr);
+}
+
+#undef LWMEM_PREF
+
+/**
+ * \}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWMEM_HDR_POOL_H */
@@ -0,0 +1,95 @@
+/**
+ * \file            lwmem_shm.h
+ * \brief           Position independent heap in shared memory segment
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#ifndef LWMEM_HDR_SHM_H
+#define LWMEM_HDR_SHM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lwmem/lwmem.h"
+
+/**
+ * \defgroup        LWMEM_SHM Shared memory heap
+ * \brief           Heap shared between processes, mapped at different addresses
+ * \ingroup         LWMEM
+ *
+ * Heap keeps all its state in memory segment, with block links stored as offsets from segment start.
+ * Segment (`shm_open`, `memfd_create` or file mapping) is initialized by one process
+ * and attached by others, regardless of address where it is mapped.
+ *
+ * Access is protected by robust process-shared mutex in the segment.
+ * Pointers are exchanged between processes as offsets, see \ref lwmem_shm_to_offset.
+ *
+ * When segment is mapped from file, heap persists together with file.
+ * After restart, it is recovered with \ref lwmem_shm_recover
+ * and application data is reached from root object, see \ref lwmem_shm_get_root.
+ *
+ * \{
+ */
+
+/* --- Memory unique part starts --- */
+/**
+ * \brief           Memory function/typedef prefix string
+ * \note            Modification of this macro must be done in \ref lwmem.h file aswell
+ */
+#define LWMEM_PREF(x)                     lwmem_ ## x
+/* --- Memory unique part ends --- */
+
+/**
+ * \brief           Shared memory heap handle, located at the start of segment
+ */
+typedef struct LWMEM_PREF(shm) LWMEM_PREF(shm_t);
+
+LWMEM_PREF(shm_t)*      LWMEM_PREF(shm_init)(void* const mem, const size_t size);
+LWMEM_PREF(shm_t)*      LWMEM_PREF(shm_attach)(void* const mem);
+LWMEM_PREF(shm_t)*      LWMEM_PREF(shm_recover)(void* const mem, const size_t size);
+unsigned char           LWMEM_PREF(shm_set_root)(LWMEM_PREF(shm_t)* const shm, void* const ptr);
+void *                  LWMEM_PREF(shm_get_root)(LWMEM_PREF(shm_t)* const shm);
+void *                  LWMEM_PREF(shm_malloc)(LWMEM_PREF(shm_t)* const shm, const size_t size);
+void                    LWMEM_PREF(shm_free)(LWMEM_PREF(shm_t)* const shm, void* const ptr);
+size_t                  LWMEM_PREF(shm_usable_size)(LWMEM_PREF(shm_t)* const shm, void* const ptr);
+size_t                  LWMEM_PREF(shm_to_offset)(LWMEM_PREF(shm_t)* const shm, const void* const ptr);
+void *                  LWMEM_PREF(shm_from_offset)(LWMEM_PREF(shm_t)* const shm, const size_t offset);
+
+#undef LWMEM_PREF
+
+/**
+ * \}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWMEM_HDR_SHM_H */
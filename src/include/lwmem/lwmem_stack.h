@@ -0,0 +1,94 @@
+/**
+ * \file            lwmem_stack.h
+ * \brief           Stack allocator for LIFO temporaries
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#ifndef LWMEM_HDR_STACK_H
+#define LWMEM_HDR_STACK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lwmem/lwmem.h"
+
+/**
+ * \defgroup        LWMEM_STACK Stack allocator
+ * \brief           Mark/release allocator for temporaries allocated in strict LIFO order
+ * \ingroup         LWMEM
+ *
+ * Stack memory is one contiguous block, taken from heap or from user region.
+ * Allocation moves top of the stack up, while \ref lwmem_stack_release
+ * releases all allocations done after the mark at once.
+ *
+ * \{
+ */
+
+/* --- Memory unique part starts --- */
+/**
+ * \brief           Memory function/typedef prefix string
+ * \note            Modification of this macro must be done in \ref lwmem.h file aswell
+ */
+#define LWMEM_PREF(x)                     lwmem_ ## x
+/* --- Memory unique part ends --- */
+
+/**
+ * \brief           Stack allocator structure
+ */
+typedef struct {
+    unsigned char* start;                       /*!< Start address of stack memory */
+    size_t size;                                /*!< Size of stack memory in units of bytes */
+    size_t top;                                 /*!< Offset of first free byte in stack memory */
+    unsigned char is_heap;                      /*!< Set to `1` when stack structure and memory are allocated from heap */
+} LWMEM_PREF(stack_t);
+
+/**
+ * \brief           Stack mark, used to release all allocations done after it
+ */
+typedef size_t LWMEM_PREF(stack_mark_t);
+
+unsigned char           LWMEM_PREF(stack_init)(LWMEM_PREF(stack_t)* const stack, void* const mem, const size_t size);
+LWMEM_PREF(stack_t)*    LWMEM_PREF(stack_create)(const size_t size);
+void                    LWMEM_PREF(stack_destroy)(LWMEM_PREF(stack_t)* const stack);
+void *                  LWMEM_PREF(stack_push)(LWMEM_PREF(stack_t)* const stack, const size_t size);
+LWMEM_PREF(stack_mark_t) LWMEM_PREF(stack_mark)(const LWMEM_PREF(stack_t)* const stack);
+void                    LWMEM_PREF(stack_release)(LWMEM_PREF(stack_t)* const stack, const LWMEM_PREF(stack_mark_t) mark);
+
+#undef LWMEM_PREF
+
+/**
+ * \}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWMEM_HDR_STACK_H */
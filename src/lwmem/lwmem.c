@@ -30,8 +30,14 @@
  *
  * Author:          Tilen MAJERLE <tilen@majerle.eu>
  */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE                             /* Required for `mremap` of large allocations */
+#endif /* defined(__linux__) && !defined(_GNU_SOURCE) */
 #include "lwmem/lwmem.h"
 #include "limits.h"
+#if LWMEM_THREAD_SAFE || LWMEM_NUMA
+#include "lwmem/lwmem_sys.h"
+#endif /* LWMEM_THREAD_SAFE */
 
 /* --- Memory unique part starts --- */
 /* Prefix for all buffer functions and typedefs */
@@ -40,6 +46,8 @@
  */
 #define LWMEM_PREF(x)                   lwmem_ ## x
 
+/* Configuration below can be overridden from compiler command line or build system */
+
 /**
  * \brief           Number of bits to align memory address and size.
  *
@@ -48,13 +56,182 @@
  *
  * \note            This value can be a power of `2`. Usually alignment of `4` bytes fits to all processors.
  */
+#ifndef LWMEM_ALIGN_NUM
 #define LWMEM_ALIGN_NUM                 ((size_t)64)
+#endif /* LWMEM_ALIGN_NUM */
+
+/**
+ * \brief           Growth reserve divider for blocks reallocated to bigger size
+ *
+ * When block is reallocated to bigger size, additional trailing capacity
+ * of `size / LWMEM_REALLOC_GROWTH_DIV` bytes is reserved in the block (when memory permits),
+ * so that next small increments are satisfied in place without copying.
+ *
+ * Reallocation to smaller size does not trim block as long as block stays within growth reserve of new size.
+ *
+ * \note            Set to `0` to disable growth reservation
+ */
+#ifndef LWMEM_REALLOC_GROWTH_DIV
+#define LWMEM_REALLOC_GROWTH_DIV        2
+#endif /* LWMEM_REALLOC_GROWTH_DIV */
+
+/**
+ * \brief           Size threshold for large allocations placed to their own memory mappings
+ *
+ * Allocations of at least this size bypass memory regions
+ * and are placed to their own anonymous memory mapping with `mmap`.
+ * Reallocation of such block is done with `mremap` and does not copy memory content,
+ * while free returns memory directly to operating system.
+ *
+ * \note            Available on Linux only. Set to `0` to disable large allocations.
+ *                  Value is used in preprocessor conditions and must not include casts, e.g. `(1UL << 20)`
+ */
+#ifndef LWMEM_LARGE_MMAP_THRESHOLD
+#define LWMEM_LARGE_MMAP_THRESHOLD      0
+#endif /* LWMEM_LARGE_MMAP_THRESHOLD */
+
+/**
+ * \brief           Number of \ref lwmem_purge calls free block must stay unused before it is purged
+ *
+ * Purge function is called periodically by application, so decay time is this number of periods
+ */
+#ifndef LWMEM_PURGE_DECAY
+#define LWMEM_PURGE_DECAY               2
+#endif /* LWMEM_PURGE_DECAY */
 
+/**
+ * \brief           Number of cache line aligned slots for allocation counters and latency histograms,
+ *                  enabled with \ref LWMEM_STATS or \ref LWMEM_LATENCY
+ *
+ * Each thread updates counters in its own slot, shared only when there are more threads than slots
+ */
+#ifndef LWMEM_STATS_SLOTS
+#define LWMEM_STATS_SLOTS               16
+#endif /* LWMEM_STATS_SLOTS */
+
+/**
+ * \brief           Size of cache line, used for allocation counter slots
+ */
+#ifndef LWMEM_STATS_CACHE_LINE
+#define LWMEM_STATS_CACHE_LINE          64
+#endif /* LWMEM_STATS_CACHE_LINE */
+
+/**
+ * \brief           Number of bits for sub-buckets of latency histograms, enabled with \ref LWMEM_LATENCY
+ *
+ * Each doubling of value has `2^LWMEM_LATENCY_SUB_BITS` buckets, which sets relative precision of histogram
+ */
+#ifndef LWMEM_LATENCY_SUB_BITS
+#define LWMEM_LATENCY_SUB_BITS          3
+#endif /* LWMEM_LATENCY_SUB_BITS */
+
+/**
+ * \brief           Number of bits of biggest value in latency histograms, bigger values are counted in last bucket
+ */
+#ifndef LWMEM_LATENCY_MAX_BITS
+#define LWMEM_LATENCY_MAX_BITS          40
+#endif /* LWMEM_LATENCY_MAX_BITS */
+
+#ifndef LWMEM_MEMSET
 #define LWMEM_MEMSET                    memset
+#endif /* LWMEM_MEMSET */
+#ifndef LWMEM_MEMCPY
 #define LWMEM_MEMCPY                    memcpy
+#endif /* LWMEM_MEMCPY */
+#ifndef LWMEM_MEMMOVE
 #define LWMEM_MEMMOVE                   memmove
+#endif /* LWMEM_MEMMOVE */
 /* --- Memory unique part ends --- */
 
+#if LWMEM_HISTOGRAM || LWMEM_LATENCY
+#include "stdio.h"
+#endif /* LWMEM_HISTOGRAM || LWMEM_LATENCY */
+
+#if LWMEM_LATENCY
+/**
+ * \brief           Read cycle counter of processor
+ *
+ * Default implementation is available for x86 and AArch64 processors with GCC and Clang compilers.
+ * Define it before including source file to use other timer
+ */
+#ifndef LWMEM_CYCLES
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include "x86intrin.h"
+#define LWMEM_CYCLES()                  ((uint64_t)__rdtsc())
+#elif defined(__GNUC__) && defined(__aarch64__)
+#define LWMEM_CYCLES()                  prv_cycles()
+
+static uint64_t
+prv_cycles(void) {
+    uint64_t value;
+
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+}
+#else
+#error "LWMEM_CYCLES must be defined for this platform"
+#endif /* defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) */
+#endif /* LWMEM_CYCLES */
+#endif /* LWMEM_LATENCY */
+
+#if LWMEM_LARGE_MMAP_THRESHOLD > 0 || LWMEM_PURGE
+#if !defined(__linux__)
+#error "LWMEM_LARGE_MMAP_THRESHOLD and LWMEM_PURGE are only supported on Linux"
+#endif /* !defined(__linux__) */
+#include "sys/mman.h"
+#include "unistd.h"
+#endif /* LWMEM_LARGE_MMAP_THRESHOLD > 0 || LWMEM_PURGE */
+
+#if LWMEM_STATS || LWMEM_LATENCY
+/**
+ * \brief           Thread local storage and atomic operations for statistics counters
+ *
+ * Default implementation uses extensions of GCC and Clang compilers when thread safety is enabled.
+ * Define all of them before including source file to use other compiler
+ */
+#ifndef LWMEM_STATS_ADD
+#if LWMEM_THREAD_SAFE
+#if !defined(__GNUC__)
+#error "LWMEM_STATS_ADD, LWMEM_STATS_READ, LWMEM_STATS_THREAD_LOCAL and LWMEM_STATS_ALIGNED must be defined for this compiler"
+#endif /* !defined(__GNUC__) */
+#define LWMEM_STATS_ADD(var, val)       __atomic_fetch_add(&(var), (val), __ATOMIC_RELAXED)
+#define LWMEM_STATS_READ(var)           __atomic_load_n(&(var), __ATOMIC_RELAXED)
+#define LWMEM_STATS_THREAD_LOCAL        __thread
+#define LWMEM_STATS_ALIGNED             __attribute__((aligned(LWMEM_STATS_CACHE_LINE)))
+#else
+#define LWMEM_STATS_ADD(var, val)       ((var) += (val), (var) - (val))
+#define LWMEM_STATS_READ(var)           (var)
+#define LWMEM_STATS_THREAD_LOCAL
+#define LWMEM_STATS_ALIGNED
+#endif /* LWMEM_THREAD_SAFE */
+#endif /* LWMEM_STATS_ADD */
+#endif /* LWMEM_STATS || LWMEM_LATENCY */
+
+#if LWMEM_PURGE
+/**
+ * \brief           Advice given to operating system for purged pages
+ *
+ * `MADV_FREE` lets system reclaim pages lazily, under memory pressure,
+ * while `MADV_DONTNEED` releases them immediately
+ */
+#ifndef LWMEM_PURGE_ADVICE
+#ifdef MADV_FREE
+#define LWMEM_PURGE_ADVICE              MADV_FREE
+#else
+#define LWMEM_PURGE_ADVICE              MADV_DONTNEED
+#endif /* MADV_FREE */
+#endif /* LWMEM_PURGE_ADVICE */
+#endif /* LWMEM_PURGE */
+
+#if LWMEM_LARGE_MMAP_THRESHOLD > 0
+/**
+ * \brief           Check if application size is placed to its own memory mapping
+ */
+#define LWMEM_SIZE_IS_LARGE(size)       ((size) >= LWMEM_LARGE_MMAP_THRESHOLD)
+#else
+#define LWMEM_SIZE_IS_LARGE(size)       0
+#endif /* LWMEM_LARGE_MMAP_THRESHOLD > 0 */
+
 /**
  * \brief           Transform alignment number (power of `2`) to bits
  */
@@ -99,6 +276,17 @@
  */
 #define LWMEM_ALLOC_BIT                 ((size_t)((size_t)1 << (sizeof(size_t) * CHAR_BIT - 1)))
 
+/**
+ * \brief           Next pointer value of large block, placed to its own memory mapping
+ */
+#define LWMEM_BLOCK_LARGE_MARK          ((void *)0xDEADB16B)
+
+/**
+ * \brief           Check if input block is large block in its own memory mapping
+ * \param[in]       block: Block to check
+ */
+#define LWMEM_BLOCK_IS_LARGE(block)     ((block) != NULL && ((block)->size & LWMEM_ALLOC_BIT) && (block)->next == LWMEM_BLOCK_LARGE_MARK)
+
 /**
  * \brief           Get block handle from application pointer
  * \param[in]       ptr: Input pointer to get block from
@@ -140,10 +328,390 @@ typedef struct lwmem_block {
                                                         or `0` when block is free */
 } lwmem_block_t;
 
+/**
+ * \brief           Region trailer, placed at the end of each region
+ *
+ * It starts with "end of region" indication block of size `0`, which is part of free blocks linked list,
+ * and keeps physical layout of regions to walk through all blocks
+ */
+typedef struct lwmem_region_trailer {
+    lwmem_block_t block;                        /*!< End of region indication block */
+    lwmem_block_t* first_block;                 /*!< Physically first block of region */
+    struct lwmem_region_trailer* next;          /*!< Trailer of next region, `NULL` for last region */
+    unsigned int node;                          /*!< NUMA node of region memory */
+} lwmem_region_trailer_t;
+
+/**
+ * \brief           Size of region trailer, aligned to \ref LWMEM_ALIGN_NUM
+ */
+#define LWMEM_REGION_TRAILER_SIZE       LWMEM_ALIGN(sizeof(lwmem_region_trailer_t))
+
 static lwmem_block_t start_block;               /*!< Holds beginning of memory allocation regions */
 static lwmem_block_t* end_block;                /*!< Pointer to the last memory location in regions linked list */
+static lwmem_region_trailer_t* first_trailer;   /*!< Trailer of first region, beginning of regions list */
 static size_t mem_available_bytes;              /*!< Memory size available for allocation */
 static size_t mem_regions_count;                /*!< Number of regions used for allocation */
+#if LWMEM_PURGE
+static size_t purge_epoch;                      /*!< Number of purge function calls */
+
+/**
+ * \brief           Purge information, placed after header of free block
+ *
+ * It is valid only when its tag matches block address and size,
+ * as information is not updated when block is modified without \ref prv_insert_free_block function
+ */
+typedef struct {
+    size_t tag;                                 /*!< Block address and size, mixed with magic number */
+    size_t epoch;                               /*!< Purge epoch when block was created */
+    size_t clean;                               /*!< Number of bytes in block returned to operating system */
+} lwmem_purge_info_t;
+
+/**
+ * \brief           Get purge information of free block
+ */
+#define LWMEM_PURGE_INFO(block)         ((lwmem_purge_info_t *)(LWMEM_TO_BYTE_PTR(block) + LWMEM_BLOCK_META_SIZE))
+
+/**
+ * \brief           Get tag of purge information for free block
+ */
+#define LWMEM_PURGE_TAG(block)          ((size_t)(block) ^ (block)->size ^ (size_t)0x5AC3A53C)
+
+/**
+ * \brief           Check if free block holds valid purge information
+ */
+#define LWMEM_PURGE_IS_VALID(block)     ((block)->size >= LWMEM_BLOCK_META_SIZE + sizeof(lwmem_purge_info_t) \
+                                            && LWMEM_PURGE_INFO(block)->tag == LWMEM_PURGE_TAG(block))
+#endif /* LWMEM_PURGE */
+#if LWMEM_STATS || LWMEM_LATENCY
+static size_t stats_next_slot;                  /*!< Slot to be assigned to next thread */
+
+/**
+ * \brief           Get counter slot of calling thread, assigned round robin on first use
+ * \return          Slot index
+ */
+static size_t
+prv_stats_slot(void) {
+    static LWMEM_STATS_THREAD_LOCAL size_t slot;    /* Slot index plus one, `0` when not assigned yet */
+
+    if (slot == 0) {
+        slot = LWMEM_STATS_ADD(stats_next_slot, 1) % LWMEM_STATS_SLOTS + 1;
+    }
+    return slot - 1;
+}
+#endif /* LWMEM_STATS || LWMEM_LATENCY */
+
+#if LWMEM_STATS
+
+/**
+ * \brief           Allocation counters, index in counter slot
+ */
+typedef enum {
+    LWMEM_STATS_ALLOC,                          /*!< Number of successful allocations */
+    LWMEM_STATS_FREE,                           /*!< Number of freed blocks */
+    LWMEM_STATS_REALLOC,                        /*!< Number of reallocations */
+    LWMEM_STATS_FAILED,                         /*!< Number of failed allocations and reallocations */
+    LWMEM_STATS_COUNT,                          /*!< Number of counters */
+} lwmem_stats_counter_t;
+
+/**
+ * \brief           Slot of allocation counters, in its own cache line
+ */
+typedef struct {
+    size_t cnt[LWMEM_STATS_COUNT];              /*!< Counter values */
+    unsigned char pad[LWMEM_STATS_CACHE_LINE - LWMEM_STATS_COUNT * sizeof(size_t)]; /*!< Padding to size of cache line */
+} lwmem_stats_slot_t;
+
+static lwmem_stats_slot_t stats_slots[LWMEM_STATS_SLOTS] LWMEM_STATS_ALIGNED;   /*!< Allocation counter slots */
+
+/**
+ * \brief           Increase allocation counter in slot of calling thread
+ * \param[in]       counter: Counter index
+ */
+static void
+prv_stats_inc(const lwmem_stats_counter_t counter) {
+    (void)LWMEM_STATS_ADD(stats_slots[prv_stats_slot()].cnt[counter], 1);
+}
+
+/**
+ * \brief           Increase allocation counter
+ */
+#define LWMEM_STATS_INC(counter)        prv_stats_inc(counter)
+#else
+#define LWMEM_STATS_INC(counter)
+#endif /* LWMEM_STATS */
+
+/**
+ * \brief           Count result of allocation
+ */
+#define LWMEM_STATS_ALLOC_RESULT(ptr)   LWMEM_STATS_INC((ptr) != NULL ? LWMEM_STATS_ALLOC : LWMEM_STATS_FAILED)
+
+#if LWMEM_LATENCY
+
+/**
+ * \brief           Number of sub-buckets per doubling of latency histogram value
+ */
+#define LWMEM_LATENCY_SUB               ((size_t)1 << LWMEM_LATENCY_SUB_BITS)
+
+/**
+ * \brief           Number of latency histogram buckets
+ */
+#define LWMEM_LATENCY_BUCKETS           ((LWMEM_LATENCY_MAX_BITS - LWMEM_LATENCY_SUB_BITS + 1) * LWMEM_LATENCY_SUB)
+
+/**
+ * \brief           Latency histogram of single operation
+ *
+ * Counters are updated with atomic operations, without protection of memory manager
+ */
+typedef struct {
+    size_t buckets[LWMEM_LATENCY_BUCKETS];      /*!< Number of values in each bucket */
+    size_t count;                               /*!< Number of all values */
+    uint64_t sum;                               /*!< Sum of all values */
+} lwmem_latency_hist_t;
+
+/**
+ * \brief           Slot of latency histograms of all operations, padded to multiple of cache line size
+ */
+typedef struct {
+    lwmem_latency_hist_t op[LWMEM_OP_COUNT];    /*!< Histograms of operations */
+    unsigned char pad[LWMEM_STATS_CACHE_LINE - sizeof(lwmem_latency_hist_t) * LWMEM_OP_COUNT % LWMEM_STATS_CACHE_LINE]; /*!< Padding to multiple of cache line size */
+} lwmem_latency_slot_t;
+
+static lwmem_latency_slot_t latency_slots[LWMEM_STATS_SLOTS] LWMEM_STATS_ALIGNED;   /*!< Latency histogram slots */
+static size_t latency_search_nodes;             /*!< Free list nodes visited by current allocation, protected by memory manager */
+
+/**
+ * \brief           Get latency histogram bucket of value
+ *
+ * Values smaller than `2` doublings of sub-buckets have bucket each,
+ * bigger values have \ref LWMEM_LATENCY_SUB buckets per doubling
+ *
+ * \param[in]       value: Value to get bucket for
+ * \return          Bucket index
+ */
+static size_t
+prv_latency_bucket(const uint64_t value) {
+    size_t bit;
+
+    if (value < 2 * LWMEM_LATENCY_SUB) {
+        return (size_t)value;
+    }
+    for (bit = LWMEM_LATENCY_SUB_BITS + 1; (value >> (bit + 1)) != 0; ++bit) {
+        if (bit == LWMEM_LATENCY_MAX_BITS - 1) {
+            return LWMEM_LATENCY_BUCKETS - 1;   /* Value is too big */
+        }
+    }
+    return (bit - LWMEM_LATENCY_SUB_BITS + 1) * LWMEM_LATENCY_SUB
+        + (size_t)((value >> (bit - LWMEM_LATENCY_SUB_BITS)) & (LWMEM_LATENCY_SUB - 1));
+}
+
+/**
+ * \brief           Get biggest value of latency histogram bucket
+ * \param[in]       bucket: Bucket index
+ * \return          Biggest value in bucket
+ */
+static uint64_t
+prv_latency_bucket_value(const size_t bucket) {
+    size_t shift;
+
+    if (bucket < 2 * LWMEM_LATENCY_SUB) {
+        return bucket;
+    }
+    shift = bucket / LWMEM_LATENCY_SUB - 1;
+    return (((uint64_t)(LWMEM_LATENCY_SUB + bucket % LWMEM_LATENCY_SUB) + 1) << shift) - 1;
+}
+
+/**
+ * \brief           Count value in latency histogram of operation, in slot of calling thread
+ * \param[in]       op: Operation
+ * \param[in]       value: Number of cycles, or nodes for \ref LWMEM_OP_SEARCH
+ */
+static void
+prv_latency_record(const LWMEM_PREF(op_t) op, const uint64_t value) {
+    lwmem_latency_hist_t* const hist = &latency_slots[prv_stats_slot()].op[op];
+
+    (void)LWMEM_STATS_ADD(hist->buckets[prv_latency_bucket(value)], 1);
+    (void)LWMEM_STATS_ADD(hist->count, 1);
+    (void)LWMEM_STATS_ADD(hist->sum, value);
+}
+
+/**
+ * \brief           Start measurement of public function, placed after declarations of local variables
+ */
+#define LWMEM_LATENCY_START()           const uint64_t latency_start = LWMEM_CYCLES(); size_t latency_nodes = 0
+
+/**
+ * \brief           Take number of free list nodes visited by allocation, placed before memory manager is released
+ */
+#define LWMEM_LATENCY_TAKE_SEARCH()     do { latency_nodes = latency_search_nodes; latency_search_nodes = 0; } while (0)
+
+/**
+ * \brief           End measurement of public function, after memory manager is released
+ */
+#define LWMEM_LATENCY_END(op)           do {                                            \
+        prv_latency_record((op), LWMEM_CYCLES() - latency_start);                       \
+        if (latency_nodes > 0) {                                                        \
+            prv_latency_record(LWMEM_OP_SEARCH, latency_nodes);                         \
+        }                                                                               \
+    } while (0)
+
+/**
+ * \brief           Count number of free list nodes visited by search, with memory manager protected
+ */
+#define LWMEM_LATENCY_SEARCH(nodes)     (latency_search_nodes += (nodes))
+#else
+#define LWMEM_LATENCY_START()
+#define LWMEM_LATENCY_TAKE_SEARCH()
+#define LWMEM_LATENCY_END(op)
+#define LWMEM_LATENCY_SEARCH(nodes)     (void)(nodes)
+#endif /* LWMEM_LATENCY */
+
+#if LWMEM_NUMA
+/**
+ * \brief           Get NUMA node of calling thread.
+ *                  Used by public functions before memory manager is locked
+ */
+#define LWMEM_CURRENT_NODE()            lwmem_sys_current_node()
+#else
+#define LWMEM_CURRENT_NODE()            0U
+#endif /* LWMEM_NUMA */
+
+#if LWMEM_THREAD_SAFE
+static LWMEM_SYS_MUTEX_TYPE mutex;              /*!< Mutex to protect memory manager in multi-thread environment */
+static unsigned char mutex_valid;               /*!< Set to `1` when mutex is created */
+
+/**
+ * \brief           Protect memory manager from concurrent access
+ */
+#define LWMEM_PROTECT()                 do { if (mutex_valid) { lwmem_sys_mutex_wait(&mutex); } } while (0)
+
+/**
+ * \brief           Release memory manager protection
+ */
+#define LWMEM_UNPROTECT()               do { if (mutex_valid) { lwmem_sys_mutex_release(&mutex); } } while (0)
+#else
+#define LWMEM_PROTECT()
+#define LWMEM_UNPROTECT()
+#endif /* LWMEM_THREAD_SAFE */
+
+#if LWMEM_LARGE_MMAP_THRESHOLD > 0 || LWMEM_PURGE
+
+/**
+ * \brief           Get page size of operating system
+ * \return          Page size in units of bytes
+ */
+static size_t
+prv_get_page_size(void) {
+    static size_t page_size;
+
+    if (page_size == 0) {
+        page_size = (size_t)sysconf(_SC_PAGESIZE);
+    }
+    return page_size;
+}
+
+#endif /* LWMEM_LARGE_MMAP_THRESHOLD > 0 || LWMEM_PURGE */
+
+#if LWMEM_PURGE
+
+/**
+ * \brief           Free block, which is split or moved, and its clean bytes
+ */
+typedef struct {
+    const unsigned char* addr;                  /*!< Block address */
+    size_t size;                                /*!< Block size */
+    size_t clean;                               /*!< Number of clean bytes in block */
+} lwmem_purge_src_t;
+
+/**
+ * \brief           Get page aligned range of free block, which is returned to operating system by purge
+ * \param[in]       addr: Block address
+ * \param[in]       size: Block size
+ * \param[out]      start: Start of range
+ * \return          Size of range in units of bytes, `0` when block does not contain complete page
+ */
+static size_t
+prv_purge_range(const unsigned char* const addr, const size_t size, const unsigned char** const start) {
+    const size_t page_size = prv_get_page_size();
+    const size_t s = ((size_t)addr + LWMEM_BLOCK_META_SIZE + sizeof(lwmem_purge_info_t) + page_size - 1) & ~(page_size - 1);
+    const size_t e = ((size_t)addr + size) & ~(page_size - 1);
+
+    *start = (const void *)s;
+    return e > s ? e - s : 0;
+}
+
+/**
+ * \brief           Get free block before it is split or moved
+ * \param[in]       block: Free block with its size
+ * \return          Block information with its clean bytes
+ */
+static lwmem_purge_src_t
+prv_purge_src(const lwmem_block_t* const block) {
+    lwmem_purge_src_t src;
+
+    src.addr = LWMEM_TO_BYTE_PTR(block);
+    src.size = block->size;
+    src.clean = LWMEM_PURGE_IS_VALID(block) ? LWMEM_PURGE_INFO(block)->clean : 0;
+    return src;
+}
+
+/**
+ * \brief           Carry clean bytes of split or moved free block to free block created from its part
+ *
+ * Position of clean pages is not kept, only their number. Part gets clean bytes of former block,
+ * reduced by size of former purge range outside of purge range of part.
+ * It is exact when former block was purged completely, and lower bound otherwise
+ *
+ * \param[in]       src: Former free block
+ * \param[in]       part: Free block in list of free blocks, created from part of former block.
+ *                      Allocated block and end of region indication are ignored
+ */
+static void
+prv_purge_carry(const lwmem_purge_src_t* const src, lwmem_block_t* const part) {
+    const unsigned char* src_start, *part_start, *lo, *hi;
+    size_t src_len, part_len, overlap, clean;
+
+    if (src->clean == 0 || part->size == 0 || (part->size & LWMEM_ALLOC_BIT)
+        || part->size < LWMEM_BLOCK_META_SIZE + sizeof(lwmem_purge_info_t)) {
+        return;
+    }
+    src_len = prv_purge_range(src->addr, src->size, &src_start);
+    part_len = prv_purge_range(LWMEM_TO_BYTE_PTR(part), part->size, &part_start);
+    lo = src_start > part_start ? src_start : part_start;
+    hi = src_start + src_len < part_start + part_len ? src_start + src_len : part_start + part_len;
+    overlap = hi > lo ? (size_t)(hi - lo) : 0;
+    clean = src->clean < src_len ? src->clean : src_len;
+    if (clean <= src_len - overlap) {
+        return;                                 /* Clean pages may all be outside of part */
+    }
+    if (!LWMEM_PURGE_IS_VALID(part)) {          /* Moved block header */
+        LWMEM_PURGE_INFO(part)->tag = LWMEM_PURGE_TAG(part);
+        LWMEM_PURGE_INFO(part)->epoch = purge_epoch;
+        LWMEM_PURGE_INFO(part)->clean = 0;
+    }
+    clean = LWMEM_PURGE_INFO(part)->clean + clean - (src_len - overlap);
+    LWMEM_PURGE_INFO(part)->clean = clean < part_len ? clean : part_len;
+}
+
+/**
+ * \brief           Keep free block information before it is split or moved
+ */
+#define LWMEM_PURGE_SRC(name, block)    const lwmem_purge_src_t name = prv_purge_src(block)
+
+/**
+ * \brief           Carry clean bytes to free block created from part of former block
+ */
+#define LWMEM_PURGE_CARRY(name, part)   prv_purge_carry(&(name), (part))
+
+/**
+ * \brief           Carry clean bytes to free block split from the end of allocated block
+ */
+#define LWMEM_PURGE_CARRY_NEXT(name, block) \
+                                        prv_purge_carry(&(name), (void *)(LWMEM_TO_BYTE_PTR(block) + ((block)->size & ~LWMEM_ALLOC_BIT)))
+#else
+#define LWMEM_PURGE_SRC(name, block)
+#define LWMEM_PURGE_CARRY(name, part)
+#define LWMEM_PURGE_CARRY_NEXT(name, block)
+#endif /* LWMEM_PURGE */
 
 /**
  * \brief           Insert free block to linked list of free blocks
@@ -152,6 +720,9 @@ static size_t mem_regions_count;                /*!< Number of regions used for
 static void
 prv_insert_free_block(lwmem_block_t* nb) {
     lwmem_block_t* prev;
+#if LWMEM_PURGE
+    size_t clean = 0;
+#endif /* LWMEM_PURGE */
 
     /* 
      * Try to find position to put new block
@@ -169,6 +740,11 @@ prv_insert_free_block(lwmem_block_t* nb) {
      * If this is the case, merge blocks together and increase previous block by new block size
      */
     if ((LWMEM_TO_BYTE_PTR(prev) + prev->size) == LWMEM_TO_BYTE_PTR(nb)) {
+#if LWMEM_PURGE
+        if (LWMEM_PURGE_IS_VALID(prev)) {       /* Merged block keeps purged pages of previous block */
+            clean = LWMEM_PURGE_INFO(prev)->clean;
+        }
+#endif /* LWMEM_PURGE */
         prev->size += nb->size;                 /* Increase current block by size of new block */
         nb = prev;                              /* New block and current are now the same thing */
         /* 
@@ -187,6 +763,11 @@ prv_insert_free_block(lwmem_block_t* nb) {
         if (prev->next == end_block) {          /* Does it points to the end? */
             nb->next = end_block;               /* Set end block pointer */
         } else {
+#if LWMEM_PURGE
+            if (LWMEM_PURGE_IS_VALID(prev->next)) { /* Merged block keeps purged pages of next block */
+                clean += LWMEM_PURGE_INFO(prev->next)->clean;
+            }
+#endif /* LWMEM_PURGE */
             nb->size += prev->next->size;       /* Expand of current block for size of next free block which is right behind new block */
             nb->next = prev->next->next;        /* Next free is pointed to the next one of previous next */
         }
@@ -201,6 +782,14 @@ prv_insert_free_block(lwmem_block_t* nb) {
     if (prev != nb) {
         prev->next = nb;
     }
+#if LWMEM_PURGE
+    if (nb->size >= LWMEM_BLOCK_META_SIZE + sizeof(lwmem_purge_info_t)) {
+        /* Block was used just now, its decay starts again */
+        LWMEM_PURGE_INFO(nb)->tag = LWMEM_PURGE_TAG(nb);
+        LWMEM_PURGE_INFO(nb)->epoch = purge_epoch;
+        LWMEM_PURGE_INFO(nb)->clean = clean;
+    }
+#endif /* LWMEM_PURGE */
 }
 
 /**
@@ -249,69 +838,495 @@ prv_split_too_big_block(lwmem_block_t* block, size_t block_size, unsigned char s
 static size_t
 block_app_size(void* const ptr) {
     lwmem_block_t* const block = LWMEM_GET_BLOCK_FROM_PTR(ptr); /* Get meta from application address */;
-    if (LWMEM_BLOCK_IS_ALLOC(block)) {          /* Check if block is valid */
+    if (LWMEM_BLOCK_IS_ALLOC(block) || LWMEM_BLOCK_IS_LARGE(block)) {   /* Check if block is valid */
         return (block->size & ~LWMEM_ALLOC_BIT) - LWMEM_BLOCK_META_SIZE;
     }
     return 0;
 }
 
+#if LWMEM_HISTOGRAM
+
 /**
- * \brief           Private allocation function
- * \param[in]       ptr: Pointer to already allocated memory, used in case of memory expand (realloc) feature.
- *                      It shall point to beginning of meta block when used.
- *                      Set to `NULL` for new allocation.
- *                      If parameter is not `NULL` and function returns `NULL`, memory is not automatically freed
- * \param[in]       size: Application wanted size, excluding size of meta header
- * \return          Pointer to allocated memory, `NULL` otherwise
+ * \brief           Number of histogram buckets, enough for any size
  */
-static void *
-prv_alloc(const size_t size) {
-    lwmem_block_t* prev, *curr;
-    void* retval = NULL;
-
-    /* Calculate final size including meta data size */
-    const size_t final_size = LWMEM_ALIGN(size) + LWMEM_BLOCK_META_SIZE;
-
-    /* Check if initialized and if size is in the limits */
-    if (end_block == NULL || final_size == LWMEM_BLOCK_META_SIZE || (final_size & LWMEM_ALLOC_BIT)) {
-        return NULL;
-    }
+#define LWMEM_HIST_BUCKETS              (4 + 4 * (sizeof(size_t) * CHAR_BIT - 2))
 
-    /* Try to find first block with has at least `size` bytes available memory */
-    prev = &start_block;                        /* Always start with start block which contains valid information about first available block */
-    curr = prev->next;                          /* Set current as next of start = first available block */
-    while (curr->size < final_size) {           /* Loop until available block contains less memory than required */
-        if (curr->next == NULL || curr == end_block) {  /* If no more blocks available */
-            return NULL;                        /* No sufficient memory available to allocate block of memory */
-        }
-        prev = curr;                            /* Set current as previous */
-        curr = curr->next;                      /* Go to next empty entry */
-    }
+/**
+ * \brief           Histogram bucket counters
+ */
+typedef struct {
+    size_t requests;                            /*!< Number of allocation requests */
+    size_t allocated;                           /*!< Number of allocated blocks */
+    size_t freed;                               /*!< Number of freed blocks */
+} lwmem_hist_counters_t;
 
-    /* There is a valid block available */
-    retval = (void *)(LWMEM_TO_BYTE_PTR(prev->next) + LWMEM_BLOCK_META_SIZE);   /* Return pointer does not include meta part */
-    prev->next = curr->next;                    /* Remove this block from linked list by setting next of previous to next of current */
+static lwmem_hist_counters_t hist[LWMEM_HIST_BUCKETS];  /*!< Allocation size histogram */
 
-    /* curr block is now removed from linked list */
-    
-    /* 
-     * If block size is bigger than required,
-     * split it to to make available memory for other allocations
-     * First check if there is enough memory for next free block entry
-     */
-    mem_available_bytes -= curr->size;          /* Decrease available bytes by allocated block size */
-    prv_split_too_big_block(curr, final_size, 1);   /* Split block if necessary and set it as allocated */
+/**
+ * \brief           Get histogram bucket of size
+ *
+ * Sizes up to `4` alignment units have bucket per unit,
+ * bigger sizes have `4` buckets per doubling. Bucket limits are multiple of \ref LWMEM_ALIGN_NUM,
+ * so aligned size is in the same bucket as requested size
+ *
+ * \param[in]       size: Size in units of bytes, greater than `0`
+ * \return          Bucket index
+ */
+static size_t
+prv_hist_bucket(const size_t size) {
+    const size_t units = (size - 1) / LWMEM_ALIGN_NUM;
+    size_t bit;
 
-    return retval;
+    if (units < 4) {
+        return units;
+    }
+    for (bit = 2; (units >> (bit + 1)) != 0; ++bit) {}
+    return 4 + (bit - 2) * 4 + ((units >> (bit - 2)) & 0x03);
 }
 
 /**
- * \brief           Free input pointer
- * \param[in]       ptr: Input pointer to free
+ * \brief           Get upper size limit of histogram bucket
+ * \param[in]       bucket: Bucket index
+ * \return          Biggest size in bucket, in units of bytes
  */
-void
+static size_t
+prv_hist_bucket_size(const size_t bucket) {
+    if (bucket < 4) {
+        return (bucket + 1) * LWMEM_ALIGN_NUM;
+    }
+    return ((size_t)(4 + (bucket - 4) % 4 + 1) << ((bucket - 4) / 4)) * LWMEM_ALIGN_NUM;
+}
+
+/**
+ * \brief           Count allocation in histogram
+ * \note            Memory manager must be protected when function is called
+ * \param[in]       size: Requested size in units of bytes
+ * \param[in]       ptr: Allocated memory, `NULL` for failed allocation
+ */
+static void
+prv_hist_alloc(const size_t size, void* const ptr) {
+    if (ptr != NULL) {
+        ++hist[prv_hist_bucket(size)].requests;
+        ++hist[prv_hist_bucket(block_app_size(ptr))].allocated;
+    }
+}
+
+/**
+ * \brief           Count free in histogram
+ * \note            Memory manager must be protected when function is called
+ * \param[in]       app_size: Usable size of freed block, `0` for invalid block
+ */
+static void
+prv_hist_free(const size_t app_size) {
+    if (app_size > 0) {
+        ++hist[prv_hist_bucket(app_size)].freed;
+    }
+}
+
+/**
+ * \brief           Count reallocation in histogram, as free of old block and allocation of new one
+ * \note            Memory manager must be protected when function is called
+ * \param[in]       old_size: Usable size of block before reallocation, `0` for no block
+ * \param[in]       size: Requested size in units of bytes
+ * \param[in]       ptr: Reallocated memory, `NULL` when reallocation failed or memory was freed
+ */
+static void
+prv_hist_resize(const size_t old_size, const size_t size, void* const ptr) {
+    if (ptr != NULL || size == 0) {
+        prv_hist_free(old_size);
+    }
+    prv_hist_alloc(size, ptr);
+}
+
+#define LWMEM_HIST_ALLOC(size, ptr)     prv_hist_alloc((size), (ptr))
+#define LWMEM_HIST_FREE(ptr)            prv_hist_free(block_app_size(ptr))
+#define LWMEM_HIST_SIZE(ptr)            block_app_size(ptr)
+#define LWMEM_HIST_RESIZE(old_size, size, ptr)  prv_hist_resize((old_size), (size), (ptr))
+#else
+#define LWMEM_HIST_ALLOC(size, ptr)
+#define LWMEM_HIST_FREE(ptr)
+#define LWMEM_HIST_SIZE(ptr)            0
+#define LWMEM_HIST_RESIZE(old_size, size, ptr)  (void)(old_size)
+#endif /* LWMEM_HISTOGRAM */
+
+/**
+ * \brief           Shrink allocated block to new size and put released memory back to free blocks
+ * \param[in]       block: Allocated block to shrink
+ * \param[in]       block_size: Current block size, without allocation bit
+ * \param[in]       final_size: New block size, including meta data size. Must be smaller than `block_size`
+ */
+static void
+prv_shrink_block(lwmem_block_t* block, const size_t block_size, const size_t final_size) {
+    lwmem_block_t* prev;
+
+    if ((block_size - final_size) >= LWMEM_BLOCK_MIN_SIZE) {
+        block->size &= ~LWMEM_ALLOC_BIT;        /* Temporarly remove allocated bit */
+        prv_split_too_big_block(block, final_size, 0);  /* Split block if necessary */
+    } else {
+        /*
+         * It is not possible to create new empty block as it is not enough memory
+         * available at the end of current block
+         * 
+         * But if block just after current one is free, 
+         * we could shift it up and increase its size by "block_size - final_size" bytes
+         */
+
+        /* Find free block before input block */
+        for (prev = &start_block; prev != NULL && prev->next < block; prev = prev->next) {}
+
+        /* Check if current block and next free are connected */
+        if ((LWMEM_TO_BYTE_PTR(block) + block_size) == LWMEM_TO_BYTE_PTR(prev->next)
+            && prev->next->size > 0) {          /* Must not be end of region indicator */
+            const size_t tmp_size = prev->next->size;
+            void* const tmp_next = prev->next->next;
+            LWMEM_PURGE_SRC(src, prev->next);
+
+            /* Shift block up, effectively increasing block */
+            prev->next = (void *)(LWMEM_TO_BYTE_PTR(prev->next) - (block_size - final_size));
+            prev->next->size = tmp_size + (block_size - final_size);
+            prev->next->next = tmp_next;
+            LWMEM_PURGE_CARRY(src, prev->next);
+            mem_available_bytes += block_size - final_size; /* Increase available bytes by new block size */
+
+            block->size = final_size;           /* Block size is requested size */
+        }
+    }
+    LWMEM_BLOCK_SET_ALLOC(block);               /* Set block as allocated */
+}
+
+/**
+ * \brief           Get block size including growth reserve for reallocation
+ * \param[in]       final_size: Requested block size, including meta data size
+ * \return          Block size with growth reserve, or `final_size` if reservation is disabled
+ */
+static size_t
+prv_get_reserve_size(const size_t final_size) {
+    size_t reserve_size = final_size;
+
+#if LWMEM_REALLOC_GROWTH_DIV > 0
+    reserve_size += LWMEM_ALIGN(final_size / LWMEM_REALLOC_GROWTH_DIV);
+    if (reserve_size < final_size || (reserve_size & LWMEM_ALLOC_BIT)) {    /* Check for overflow */
+        reserve_size = final_size;
+    }
+#endif /* LWMEM_REALLOC_GROWTH_DIV > 0 */
+    return reserve_size;
+}
+
+/**
+ * \brief           Get final block size for block expanded during reallocation
+ *
+ * Block keeps as much of growth reserve as available in its current size
+ *
+ * \param[in]       block_size: Current size of expanded block, including meta data size
+ * \param[in]       final_size: Requested block size, including meta data size
+ * \return          Size to split expanded block to
+ */
+static size_t
+prv_get_grow_size(const size_t block_size, const size_t final_size) {
+    const size_t reserve_size = prv_get_reserve_size(final_size);
+    return reserve_size < block_size ? reserve_size : block_size;
+}
+
+#if LWMEM_LARGE_MMAP_THRESHOLD > 0
+
+/**
+ * \brief           Get size of memory mapping for large block
+ * \param[in]       size: Application wanted size, excluding size of meta header
+ * \return          Page aligned mapping size including meta header, `0` on overflow
+ */
+static size_t
+prv_large_get_map_size(const size_t size) {
+    const size_t page_size = prv_get_page_size();
+    size_t map_size;
+
+    map_size = (size + LWMEM_BLOCK_META_SIZE + page_size - 1) & ~(page_size - 1);
+    if (map_size < size || (map_size & LWMEM_ALLOC_BIT)) {
+        return 0;
+    }
+    return map_size;
+}
+
+/**
+ * \brief           Allocate large block in its own memory mapping
+ * \param[in]       size: Application wanted size, excluding size of meta header
+ * \return          Pointer to allocated memory, `NULL` otherwise
+ */
+static void *
+prv_large_alloc(const size_t size) {
+    lwmem_block_t* block;
+    const size_t map_size = prv_large_get_map_size(size);
+
+    if (map_size == 0) {
+        return NULL;
+    }
+    block = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (block == MAP_FAILED) {
+        return NULL;
+    }
+    block->size = map_size | LWMEM_ALLOC_BIT;   /* Mapping size is block size */
+    block->next = LWMEM_BLOCK_LARGE_MARK;       /* Mark block as large */
+    return LWMEM_TO_BYTE_PTR(block) + LWMEM_BLOCK_META_SIZE;
+}
+
+/**
+ * \brief           Reallocate large block by remapping its memory
+ *
+ * When allowed, operating system may move mapping to new virtual address.
+ * Memory content is not copied but page table entries are moved instead
+ *
+ * \param[in]       block: Large block to reallocate
+ * \param[in]       size: Application wanted size, excluding size of meta header
+ * \param[in]       flags: `MREMAP_MAYMOVE` to allow moving mapping, `0` to resize it in place only
+ * \return          Pointer to reallocated memory, `NULL` otherwise
+ */
+static void *
+prv_large_realloc(lwmem_block_t* block, const size_t size, const int flags) {
+    const size_t map_size = prv_large_get_map_size(size);
+
+    if (map_size == 0) {
+        return NULL;
+    }
+    if (map_size != (block->size & ~LWMEM_ALLOC_BIT)) {
+        block = mremap(block, block->size & ~LWMEM_ALLOC_BIT, map_size, flags);
+        if (block == MAP_FAILED) {
+            return NULL;
+        }
+        block->size = map_size | LWMEM_ALLOC_BIT;
+    }
+    return LWMEM_TO_BYTE_PTR(block) + LWMEM_BLOCK_META_SIZE;
+}
+
+/**
+ * \brief           Free large block and return its memory to operating system
+ * \param[in]       block: Large block to free
+ */
+static void
+prv_large_free(lwmem_block_t* block) {
+    munmap(block, block->size & ~LWMEM_ALLOC_BIT);
+}
+
+#endif /* LWMEM_LARGE_MMAP_THRESHOLD > 0 */
+
+/**
+ * \brief           Private allocation function
+ * \param[in]       ptr: Pointer to already allocated memory, used in case of memory expand (realloc) feature.
+ *                      It shall point to beginning of meta block when used.
+ *                      Set to `NULL` for new allocation.
+ *                      If parameter is not `NULL` and function returns `NULL`, memory is not automatically freed
+ * \param[in]       size: Application wanted size, excluding size of meta header
+ * \return          Pointer to allocated memory, `NULL` otherwise
+ */
+static void *
+prv_alloc(const size_t size) {
+    lwmem_block_t* prev, *curr;
+    void* retval = NULL;
+    size_t nodes = 1;
+
+    /* Calculate final size including meta data size */
+    const size_t final_size = LWMEM_ALIGN(size) + LWMEM_BLOCK_META_SIZE;
+
+    /* Check if initialized and if size is in the limits */
+    if (end_block == NULL || final_size == LWMEM_BLOCK_META_SIZE || (final_size & LWMEM_ALLOC_BIT)) {
+        return NULL;
+    }
+
+    /* Try to find first block with has at least `size` bytes available memory */
+    prev = &start_block;                        /* Always start with start block which contains valid information about first available block */
+    curr = prev->next;                          /* Set current as next of start = first available block */
+    while (curr->size < final_size) {           /* Loop until available block contains less memory than required */
+        if (curr->next == NULL || curr == end_block) {  /* If no more blocks available */
+            LWMEM_LATENCY_SEARCH(nodes);
+            return NULL;                        /* No sufficient memory available to allocate block of memory */
+        }
+        prev = curr;                            /* Set current as previous */
+        curr = curr->next;                      /* Go to next empty entry */
+        ++nodes;
+    }
+    LWMEM_LATENCY_SEARCH(nodes);
+
+    /* There is a valid block available */
+    retval = (void *)(LWMEM_TO_BYTE_PTR(prev->next) + LWMEM_BLOCK_META_SIZE);   /* Return pointer does not include meta part */
+    prev->next = curr->next;                    /* Remove this block from linked list by setting next of previous to next of current */
+
+    /* curr block is now removed from linked list */
+    
+    /* 
+     * If block size is bigger than required,
+     * split it to to make available memory for other allocations
+     * First check if there is enough memory for next free block entry
+     */
+    LWMEM_PURGE_SRC(src, curr);
+    mem_available_bytes -= curr->size;          /* Decrease available bytes by allocated block size */
+    prv_split_too_big_block(curr, final_size, 1);   /* Split block if necessary and set it as allocated */
+    LWMEM_PURGE_CARRY_NEXT(src, curr);          /* Remaining part keeps its clean pages */
+
+    return retval;
+}
+
+/**
+ * \brief           Private allocation function for memory with alignment bigger than \ref LWMEM_ALIGN_NUM
+ *
+ * Free block is searched with first-fit algorithm, taking alignment padding into account.
+ * Padding at the beginning of free block is put back to free blocks as separate block
+ *
+ * \param[in]       alignment: Alignment of application memory, power of `2` bigger than \ref LWMEM_ALIGN_NUM
+ * \param[in]       size: Application wanted size, excluding size of meta header
+ * \return          Pointer to allocated memory, `NULL` otherwise
+ */
+static void *
+prv_alloc_aligned(const size_t alignment, const size_t size) {
+    lwmem_block_t* prev, *curr, *block;
+    size_t gap, nodes = 1;
+
+    /* Calculate final size including meta data size */
+    const size_t final_size = LWMEM_ALIGN(size) + LWMEM_BLOCK_META_SIZE;
+
+    /* Check if initialized and if size is in the limits */
+    if (end_block == NULL || final_size == LWMEM_BLOCK_META_SIZE || (final_size & LWMEM_ALLOC_BIT)) {
+        return NULL;
+    }
+
+    /* Find first block with enough memory for aligned allocation */
+    for (prev = &start_block, curr = prev->next; ; prev = curr, curr = curr->next, ++nodes) {
+        if (curr->size > 0) {
+            /* Gap between free block start and new block meta must be zero or big enough for free block */
+            gap = ((alignment - (((size_t)curr + LWMEM_BLOCK_META_SIZE) & (alignment - 1))) & (alignment - 1));
+            while (gap > 0 && gap < LWMEM_BLOCK_MIN_SIZE) {
+                gap += alignment;
+            }
+            if (gap < curr->size && (curr->size - gap) >= final_size) {
+                break;
+            }
+        }
+        if (curr->next == NULL || curr == end_block) {  /* If no more blocks available */
+            LWMEM_LATENCY_SEARCH(nodes);
+            return NULL;                        /* No sufficient memory available to allocate block of memory */
+        }
+    }
+    LWMEM_LATENCY_SEARCH(nodes);
+
+    /* Remove block from linked list */
+    LWMEM_PURGE_SRC(src, curr);
+    prev->next = curr->next;
+    mem_available_bytes -= curr->size;
+
+    /* Put padding at the beginning back to list of free blocks */
+    block = (void *)(LWMEM_TO_BYTE_PTR(curr) + gap);
+    block->size = curr->size - gap;
+    if (gap > 0) {
+        curr->size = gap;
+        mem_available_bytes += curr->size;
+        prv_insert_free_block(curr);
+        LWMEM_PURGE_CARRY(src, curr);
+    }
+    prv_split_too_big_block(block, final_size, 1); /* Split block if necessary and set it as allocated */
+    LWMEM_PURGE_CARRY_NEXT(src, block);
+
+    return LWMEM_TO_BYTE_PTR(block) + LWMEM_BLOCK_META_SIZE;
+}
+
+/**
+ * \brief           Private allocation function in regions of specific NUMA node
+ *
+ * Regions of other nodes are skipped at their end of region indication,
+ * without walking through their free blocks
+ *
+ * \param[in]       size: Application wanted size, excluding size of meta header
+ * \param[in]       node: NUMA node of region memory
+ * \return          Pointer to allocated memory, `NULL` otherwise
+ */
+static void *
+prv_alloc_node(const size_t size, const unsigned int node) {
+    lwmem_region_trailer_t* trailer;
+    lwmem_block_t* prev, *curr = NULL;
+    size_t nodes = 0;
+
+    /* Calculate final size including meta data size */
+    const size_t final_size = LWMEM_ALIGN(size) + LWMEM_BLOCK_META_SIZE;
+
+    /* Check if initialized and if size is in the limits */
+    if (end_block == NULL || final_size == LWMEM_BLOCK_META_SIZE || (final_size & LWMEM_ALLOC_BIT)) {
+        return NULL;
+    }
+
+    /* Free blocks of each region are followed by its end block in linked list */
+    prev = &start_block;
+    for (trailer = first_trailer; trailer != NULL; trailer = trailer->next) {
+        if (trailer->node == node) {
+            for (curr = prev->next, ++nodes; curr != &trailer->block && curr->size < final_size; prev = curr, curr = curr->next, ++nodes) {}
+            if (curr != &trailer->block) {
+                break;                          /* Block found */
+            }
+        }
+        prev = &trailer->block;                 /* Continue with first free block of next region */
+    }
+    LWMEM_LATENCY_SEARCH(nodes);
+    if (trailer == NULL) {
+        return NULL;
+    }
+
+    LWMEM_PURGE_SRC(src, curr);
+    prev->next = curr->next;                    /* Remove block from linked list */
+    mem_available_bytes -= curr->size;
+    prv_split_too_big_block(curr, final_size, 1);   /* Split block if necessary and set it as allocated */
+    LWMEM_PURGE_CARRY_NEXT(src, curr);
+
+    return LWMEM_TO_BYTE_PTR(curr) + LWMEM_BLOCK_META_SIZE;
+}
+
+/**
+ * \brief           Private allocation function, preferring regions of local NUMA node
+ * \param[in]       size: Application wanted size, excluding size of meta header
+ * \param[in]       node: NUMA node of calling thread, looked up before memory manager is locked
+ * \return          Pointer to allocated memory, `NULL` otherwise
+ */
+static void *
+prv_alloc_local(const size_t size, const unsigned int node) {
+#if LWMEM_NUMA
+    if (mem_regions_count > 1) {
+        void* const ptr = prv_alloc_node(size, node);   /* Prefer local node */
+        if (ptr != NULL) {
+            return ptr;
+        }
+    }
+#else
+    (void)node;
+#endif /* LWMEM_NUMA */
+    return prv_alloc(size);
+}
+
+/**
+ * \brief           Private allocation function, including large allocations
+ * \param[in]       size: Application wanted size, excluding size of meta header
+ * \param[in]       node: NUMA node of calling thread, looked up before memory manager is locked
+ * \return          Pointer to allocated memory, `NULL` otherwise
+ */
+static void *
+prv_malloc(const size_t size, const unsigned int node) {
+#if LWMEM_LARGE_MMAP_THRESHOLD > 0
+    if (size >= LWMEM_LARGE_MMAP_THRESHOLD) {
+        void* const ptr = prv_large_alloc(size);
+        if (ptr != NULL) {
+            return ptr;
+        }
+    }
+#endif /* LWMEM_LARGE_MMAP_THRESHOLD > 0 */
+    return prv_alloc_local(size, node);
+}
+
+/**
+ * \brief           Free input pointer
+ * \param[in]       ptr: Input pointer to free
+ */
+void
 prv_free(void* const ptr) {
     lwmem_block_t* const block = LWMEM_GET_BLOCK_FROM_PTR(ptr);
+#if LWMEM_LARGE_MMAP_THRESHOLD > 0
+    if (LWMEM_BLOCK_IS_LARGE(block)) {
+        prv_large_free(block);                  /* Unmap large block */
+        return;
+    }
+#endif /* LWMEM_LARGE_MMAP_THRESHOLD > 0 */
     if (LWMEM_BLOCK_IS_ALLOC(block)) {          /* Check if block is valid */
         block->size &= ~LWMEM_ALLOC_BIT;        /* Clear allocated bit indication */
 
@@ -332,11 +1347,20 @@ LWMEM_PREF(assignmem)(const LWMEM_PREF(region_t)* regions, const size_t len) {
     unsigned char* mem_start_addr;
     size_t mem_size;
     lwmem_block_t* first_block, *prev_end_block;
+    lwmem_region_trailer_t* trailer;
 
     if (end_block != NULL                       /* Init function may only be called once */
         || (LWMEM_ALIGN_NUM & (LWMEM_ALIGN_NUM - 1))) { /* Must be power of 2 */
         return 0;
     }
+#if LWMEM_THREAD_SAFE
+    if (!mutex_valid) {
+        if (!lwmem_sys_mutex_create(&mutex)) {
+            return 0;
+        }
+        mutex_valid = 1;
+    }
+#endif /* LWMEM_THREAD_SAFE */
 
     /* Ensure regions are growing linearly and do not overlap in between */
     mem_start_addr = (void *)0;
@@ -358,23 +1382,20 @@ LWMEM_PREF(assignmem)(const LWMEM_PREF(region_t)* regions, const size_t len) {
          * It is ok to cast to size_t, even if pointer could be larger
          * Important is to check lower-bytes (and bits)
          */
-        mem_size = regions->size & ~LWMEM_ALIGN_BITS;   /* Size does not include lower bits */
-        if (mem_size < (2 * LWMEM_BLOCK_MIN_SIZE)) {
-            continue;                           /* Ignore region, go to next one */
-        }
-
-        /*
-         * Start address must be aligned to configuration
-         * Increase start address and decrease effective region size
-         */
         mem_start_addr = regions->start_addr;
+        mem_size = regions->size;
         if (((size_t)mem_start_addr) & LWMEM_ALIGN_BITS) {  /* Check alignment boundary */
-            mem_start_addr += LWMEM_ALIGN_NUM - ((size_t)mem_start_addr & LWMEM_ALIGN_BITS);
-            mem_size -= mem_start_addr - LWMEM_TO_BYTE_PTR(regions->start_addr);
+            const size_t pad = LWMEM_ALIGN_NUM - ((size_t)mem_start_addr & LWMEM_ALIGN_BITS);
+            if (mem_size < pad) {
+                continue;                       /* Ignore region, go to next one */
+            }
+            mem_start_addr += pad;
+            mem_size -= pad;
         }
-        
+        mem_size &= ~LWMEM_ALIGN_BITS;          /* Size does not include lower bits */
+
         /* Ensure region size has enough memory after all the alignment checks */
-        if (mem_size < (2 * LWMEM_BLOCK_MIN_SIZE)) {
+        if (mem_size < (LWMEM_BLOCK_MIN_SIZE + LWMEM_REGION_TRAILER_SIZE)) {
             continue;                           /* Ignore region, go to next one */
         }
 
@@ -396,8 +1417,9 @@ LWMEM_PREF(assignmem)(const LWMEM_PREF(region_t)* regions, const size_t len) {
         /* Save current end block status as it is used later for linked list insertion */
         prev_end_block = end_block;
 
-        /* Put end block to the end of the region with size = 0 */
-        end_block = (void *)(mem_start_addr + mem_size - LWMEM_BLOCK_META_SIZE);
+        /* Put region trailer with end block to the end of the region with size = 0 */
+        trailer = (void *)(mem_start_addr + mem_size - LWMEM_REGION_TRAILER_SIZE);
+        end_block = &trailer->block;
         end_block->next = NULL;                 /* End block in region does not have next entry */
         end_block->size = 0;                    /* Size of end block is zero */
 
@@ -405,17 +1427,25 @@ LWMEM_PREF(assignmem)(const LWMEM_PREF(region_t)* regions, const size_t len) {
          * Create memory region first block.
          *
          * First block meta size includes size of metadata too
-         * Subtract MEM_BLOCK_META_SIZE as there is one more block (end_block) at the end of region
+         * Subtract LWMEM_REGION_TRAILER_SIZE as there is region trailer with end block at the end of region
          *
-         * Actual maximal available size for application in the region is mem_size - 2 * MEM_BLOCK_META_SIZE
+         * Actual maximal available size for application in the region is
+         * mem_size - LWMEM_BLOCK_META_SIZE - LWMEM_REGION_TRAILER_SIZE
          */
         first_block = (void *)mem_start_addr;
         first_block->next = end_block;          /* Next block of first is last block */
-        first_block->size = mem_size - LWMEM_BLOCK_META_SIZE;
+        first_block->size = mem_size - LWMEM_REGION_TRAILER_SIZE;
+
+        trailer->first_block = first_block;
+        trailer->next = NULL;
+        trailer->node = regions->node;
 
         /* Check if previous regions exist by checking previous end block state */
         if (prev_end_block != NULL) {
             prev_end_block->next = first_block; /* End block of previous region now points to start of current region */
+            ((lwmem_region_trailer_t *)prev_end_block)->next = trailer;
+        } else {
+            first_trailer = trailer;
         }
 
         mem_available_bytes += first_block->size;   /* Increase number of available bytes */
@@ -433,49 +1463,158 @@ LWMEM_PREF(assignmem)(const LWMEM_PREF(region_t)* regions, const size_t len) {
  */
 void *
 LWMEM_PREF(malloc)(const size_t size) {
-    return prv_alloc(size);
+    void* ptr;
+    const unsigned int node = LWMEM_CURRENT_NODE();
+    LWMEM_LATENCY_START();
+
+    LWMEM_PROTECT();
+    ptr = prv_malloc(size, node);
+    LWMEM_HIST_ALLOC(size, ptr);
+    LWMEM_LATENCY_TAKE_SEARCH();
+    LWMEM_UNPROTECT();
+    LWMEM_STATS_ALLOC_RESULT(ptr);
+    LWMEM_LATENCY_END(LWMEM_OP_MALLOC);
+    return ptr;
 }
 
 /**
- * \brief           Allocate contiguous block of memory for requested number of items and its size.
+ * \brief           Allocate memory of at least requested size and report its usable size
  *
- * It resets allocated block of memory to zero if allocation is successful
+ * Allocated block may be bigger than requested size due to alignment and block splitting.
+ * Application may use complete reported size without calling reallocation function
  *
- * \note            Function declaration is in-line with standard C function `calloc`
- * \param[in]       nitems: Number of elements to be allocated
- * \param[in]       size: Size of each element, in units of bytes
+ * \param[in]       size: Number of bytes to allocate
+ * \param[out]      actual: Pointer to output variable to write usable size of allocated memory to.
+ *                      Set to `0` if allocation fails. It may be set to `NULL` if not used
  * \return          Pointer to allocated memory on success, `NULL` otherwise
  */
 void *
-LWMEM_PREF(calloc)(const size_t nitems, const size_t size) {
-    void* ptr;
-    const size_t s = size * nitems;
+LWMEM_PREF(malloc_at_least)(const size_t size, size_t* const actual) {
+    void* const ptr = LWMEM_PREF(malloc)(size);
 
-    if ((ptr = prv_alloc(s)) != NULL) {
-        LWMEM_MEMSET(ptr, 0x00, s);
+    if (actual != NULL) {
+        *actual = ptr != NULL ? block_app_size(ptr) : 0;
     }
     return ptr;
 }
 
 /**
- * \brief           Reallocates already allocated memory with new size
- *
- * Function behaves differently, depends on input parameter of `ptr` and `size`:
- *
- *  - `ptr == NULL; size == 0`: Function returns `NULL`, no memory is allocated or freed
- *  - `ptr == NULL; size != 0`: Function tries to allocate new block of memory with `size` length, equivalent to `malloc(size)`
- *  - `ptr != NULL; size == 0`: Function frees memory, equivalent to `free(ptr)`
- *  - `ptr != NULL; size != 0`: Function tries to allocate new memory of copy content before returning pointer on success
+ * \brief           Allocate memory of requested size with specific alignment
+ * \note            Function declaration is in-line with standard C function `aligned_alloc`,
+ *                      except that size does not need to be multiple of alignment.
+ *                      Reallocation of memory does not keep alignment bigger than \ref LWMEM_ALIGN_NUM
+ * \param[in]       alignment: Alignment of memory, must be power of `2`
+ * \param[in]       size: Number of bytes to allocate
+ * \return          Pointer to allocated memory on success, `NULL` otherwise
+ */
+void *
+LWMEM_PREF(malloc_aligned)(const size_t alignment, const size_t size) {
+    void* ptr;
+    unsigned int node;
+    LWMEM_LATENCY_START();
+
+    if (alignment == 0 || (alignment & (alignment - 1))) {  /* Must be power of 2 */
+        return NULL;
+    }
+    node = LWMEM_CURRENT_NODE();
+    LWMEM_PROTECT();
+    if (alignment <= LWMEM_ALIGN_NUM) {
+        ptr = prv_malloc(size, node);           /* Every allocation is already aligned */
+    } else {
+        ptr = prv_alloc_aligned(alignment, size);
+    }
+    LWMEM_HIST_ALLOC(size, ptr);
+    LWMEM_LATENCY_TAKE_SEARCH();
+    LWMEM_UNPROTECT();
+    LWMEM_STATS_ALLOC_RESULT(ptr);
+    LWMEM_LATENCY_END(LWMEM_OP_MALLOC_ALIGNED);
+    return ptr;
+}
+
+/**
+ * \brief           Allocate memory of requested size on specific NUMA node
  *
- * \note            Function declaration is in-line with standard C function `realloc`
+ * Memory is allocated in regions assigned with the same node.
+ * When they do not have enough memory, it is allocated in regions of other nodes
  *
- * \param[in]       ptr: Memory block previously allocated with one of allocation functions.
- *                      It may be set to `NULL` to create new clean allocation
- * \param[in]       size: Size of new memory to reallocate
+ * \param[in]       size: Number of bytes to allocate
+ * \param[in]       node: Preferred NUMA node
  * \return          Pointer to allocated memory on success, `NULL` otherwise
  */
 void *
-LWMEM_PREF(realloc)(void* const ptr, const size_t size) {
+LWMEM_PREF(malloc_node)(const size_t size, const unsigned int node) {
+    void* ptr = NULL;
+    const unsigned int local_node = LWMEM_CURRENT_NODE();
+    LWMEM_LATENCY_START();
+
+    LWMEM_PROTECT();
+    if (!LWMEM_SIZE_IS_LARGE(size)) {           /* Pages of large block are placed by operating system */
+        ptr = prv_alloc_node(size, node);
+    }
+    if (ptr == NULL) {
+        ptr = prv_malloc(size, local_node);     /* Fall back to other nodes */
+    }
+    LWMEM_HIST_ALLOC(size, ptr);
+    LWMEM_LATENCY_TAKE_SEARCH();
+    LWMEM_UNPROTECT();
+    LWMEM_STATS_ALLOC_RESULT(ptr);
+    LWMEM_LATENCY_END(LWMEM_OP_MALLOC_NODE);
+    return ptr;
+}
+
+/**
+ * \brief           Allocate contiguous block of memory for requested number of items and its size.
+ *
+ * It resets allocated block of memory to zero if allocation is successful
+ *
+ * \note            Function declaration is in-line with standard C function `calloc`
+ * \param[in]       nitems: Number of elements to be allocated
+ * \param[in]       size: Size of each element, in units of bytes
+ * \return          Pointer to allocated memory on success, `NULL` otherwise
+ */
+void *
+LWMEM_PREF(calloc)(const size_t nitems, const size_t size) {
+    void* ptr;
+    unsigned int node;
+    const size_t s = size * nitems;
+    LWMEM_LATENCY_START();
+
+#if LWMEM_LARGE_MMAP_THRESHOLD > 0
+    if (s >= LWMEM_LARGE_MMAP_THRESHOLD
+        && (ptr = prv_large_alloc(s)) != NULL) {
+#if LWMEM_HISTOGRAM
+        LWMEM_PROTECT();
+        LWMEM_HIST_ALLOC(s, ptr);
+        LWMEM_UNPROTECT();
+#endif /* LWMEM_HISTOGRAM */
+        LWMEM_STATS_INC(LWMEM_STATS_ALLOC);
+        LWMEM_LATENCY_END(LWMEM_OP_CALLOC);
+        return ptr;                             /* Anonymous mapping is already set to zero */
+    }
+#endif /* LWMEM_LARGE_MMAP_THRESHOLD > 0 */
+    node = LWMEM_CURRENT_NODE();
+    LWMEM_PROTECT();
+    ptr = prv_alloc_local(s, node);
+    LWMEM_HIST_ALLOC(s, ptr);
+    LWMEM_LATENCY_TAKE_SEARCH();
+    LWMEM_UNPROTECT();
+    LWMEM_STATS_ALLOC_RESULT(ptr);
+    if (ptr != NULL) {
+        LWMEM_MEMSET(ptr, 0x00, s);
+    }
+    LWMEM_LATENCY_END(LWMEM_OP_CALLOC);
+    return ptr;
+}
+
+/**
+ * \brief           Private reallocation function
+ * \param[in]       ptr: Memory block previously allocated with one of allocation functions
+ * \param[in]       size: Size of new memory to reallocate
+ * \param[in]       node: NUMA node of calling thread, used when new block is allocated
+ * \return          Pointer to allocated memory on success, `NULL` otherwise
+ */
+static void *
+prv_realloc(void* const ptr, const size_t size, const unsigned int node) {
     lwmem_block_t* block, *prevprev, *prev;
     size_t block_size;
     void* retval;
@@ -486,12 +1625,12 @@ LWMEM_PREF(realloc)(void* const ptr, const size_t size) {
     /* Check optional input parameters */
     if (size == 0) {
         if (ptr != NULL) {
-            LWMEM_PREF(free)(ptr);
+            prv_free(ptr);
         }
         return NULL;
     }
     if (ptr == NULL) {
-        return prv_alloc(size);
+        return prv_malloc(size, node);
     }
 
     /* Try to reallocate existing pointer */
@@ -502,6 +1641,20 @@ LWMEM_PREF(realloc)(void* const ptr, const size_t size) {
     /* Process existing block */
     retval = NULL;
     block = LWMEM_GET_BLOCK_FROM_PTR(ptr);
+#if LWMEM_LARGE_MMAP_THRESHOLD > 0
+    if (LWMEM_BLOCK_IS_LARGE(block)) {
+        return prv_large_realloc(block, size, MREMAP_MAYMOVE);  /* Large block stays in its own mapping */
+    }
+    if (size >= LWMEM_LARGE_MMAP_THRESHOLD && LWMEM_BLOCK_IS_ALLOC(block)) {
+        /* Block grows over threshold, move it to its own mapping */
+        if ((retval = prv_large_alloc(size)) != NULL) {
+            block_size = block_app_size(ptr);
+            LWMEM_MEMCPY(retval, ptr, size > block_size ? block_size : size);
+            prv_free(ptr);
+            return retval;
+        }
+    }
+#endif /* LWMEM_LARGE_MMAP_THRESHOLD > 0 */
     if (LWMEM_BLOCK_IS_ALLOC(block)) {
         block_size = block->size & ~LWMEM_ALLOC_BIT;/* Get actual block size, without memory allocation bit */
 
@@ -520,38 +1673,14 @@ LWMEM_PREF(realloc)(void* const ptr, const size_t size) {
          * Application returns same pointer back to user.
          */
         if (final_size < block_size) {
-            if ((block_size - final_size) >= LWMEM_BLOCK_MIN_SIZE) {
-                block->size &= LWMEM_ALLOC_BIT; /* Temporarly remove allocated bit */
-                prv_split_too_big_block(block, final_size, 0);  /* Split block if necessary */
-            } else {
+            if (block_size <= prv_get_reserve_size(final_size)) {
                 /*
-                 * It is not possible to create new empty block as it is not enough memory
-                 * available at the end of current block
-                 * 
-                 * But if block just after current one is free, 
-                 * we could shift it up and increase its size by "block_size - final_size" bytes
+                 * Block is still within growth reserve of new size.
+                 * Keep it as is, so that next increment is done in place
                  */
-
-                /* Find free blocks before input block */
-                LWMEM_GET_PREV_CURR_OF_BLOCK(block, prevprev, prev);
-
-                /* Check if current block and next free are connected */
-                if ((LWMEM_TO_BYTE_PTR(block) + block_size) == LWMEM_TO_BYTE_PTR(prev->next)
-                    && prev->next->size > 0) {  /* Must not be end of region indicator */
-                    const size_t tmp_size = prev->next->size;
-                    void* const tmp_next = prev->next->next;
-
-                    /* Shift block up, effectively increasing block */
-                    prev->next = (void *)(LWMEM_TO_BYTE_PTR(prev->next) - (block_size - final_size));
-                    prev->next->size = tmp_size + (block_size - final_size);
-                    prev->next->next = tmp_next;
-                    mem_available_bytes += block_size - final_size; /* Increase available bytes by new block size */
-
-                    block->size = final_size;   /* Block size is requested size */
-                }
+            } else {
+                prv_shrink_block(block, block_size, final_size);
             }
-            LWMEM_BLOCK_SET_ALLOC(block);       /* Set block as allocated */
-            
             return ptr;                         /* Return existing pointer */
         }
 
@@ -572,11 +1701,13 @@ LWMEM_PREF(realloc)(void* const ptr, const size_t size) {
              */
             if ((block_size + prev->next->size) >= final_size) {
                 /* Merge blocks together by increasing its size and removing it from free list */
+                LWMEM_PURGE_SRC(src, prev->next);
                 mem_available_bytes -= prev->next->size;/* For now decrease effective available bytes */
                 block->size = block_size + prev->next->size;/* Increase effective size of new block */
                 prev->next = prev->next->next;  /* Set next to next's next, effectively remove expanded block from free list */
 
-                prv_split_too_big_block(block, final_size, 1);  /* Split block if necessary and set it as allocated */
+                prv_split_too_big_block(block, prv_get_grow_size(block->size, final_size), 1);  /* Split block if necessary, keep growth reserve and set it as allocated */
+                LWMEM_PURGE_CARRY_NEXT(src, block);
                 return ptr;                     /* Return existing pointer */
             }
         }
@@ -595,6 +1726,7 @@ LWMEM_PREF(realloc)(void* const ptr, const size_t size) {
                 /* Move memory from block to block previous to current */
                 void* const old_data_ptr = (LWMEM_TO_BYTE_PTR(block) + LWMEM_BLOCK_META_SIZE);
                 void* const new_data_ptr = (LWMEM_TO_BYTE_PTR(prev) + LWMEM_BLOCK_META_SIZE);
+                LWMEM_PURGE_SRC(src, prev);     /* Before purge information is overwritten */
                 LWMEM_MEMMOVE(new_data_ptr, old_data_ptr, block_size);  /* Copy old buffer size to new location */
 
                 /*
@@ -607,7 +1739,8 @@ LWMEM_PREF(realloc)(void* const ptr, const size_t size) {
                 prevprev->next = prev->next;    /* Remove curr from free list as it is now being used for allocation together with existing block */
                 block = prev;                   /* Block is now current */
 
-                prv_split_too_big_block(block, final_size, 1);  /* Split block if necessary and set it as allocated */
+                prv_split_too_big_block(block, prv_get_grow_size(block->size, final_size), 1);  /* Split block if necessary, keep growth reserve and set it as allocated */
+                LWMEM_PURGE_CARRY_NEXT(src, block);
                 return new_data_ptr;            /* Return new data ptr */
             }
         }
@@ -630,6 +1763,8 @@ LWMEM_PREF(realloc)(void* const ptr, const size_t size) {
                 /* Move memory from block to block previous to current */
                 void* const old_data_ptr = (LWMEM_TO_BYTE_PTR(block) + LWMEM_BLOCK_META_SIZE);
                 void* const new_data_ptr = (LWMEM_TO_BYTE_PTR(prev) + LWMEM_BLOCK_META_SIZE);
+                LWMEM_PURGE_SRC(src_prev, prev);    /* Before purge information is overwritten */
+                LWMEM_PURGE_SRC(src_next, prev->next);
                 LWMEM_MEMMOVE(new_data_ptr, old_data_ptr, block_size);  /* Copy old buffer size to new location */
 
                 /*
@@ -645,7 +1780,9 @@ LWMEM_PREF(realloc)(void* const ptr, const size_t size) {
                 prevprev->next = prev->next->next;  /* Remove free block before current one and block after current one from linked list */
                 block = prev;                   /* Previous block is now current */
 
-                prv_split_too_big_block(block, final_size, 1);  /* Split block if necessary and set it as allocated */
+                prv_split_too_big_block(block, prv_get_grow_size(block->size, final_size), 1);  /* Split block if necessary, keep growth reserve and set it as allocated */
+                LWMEM_PURGE_CARRY_NEXT(src_prev, block);
+                LWMEM_PURGE_CARRY_NEXT(src_next, block);
                 return new_data_ptr;            /* Return new data ptr */
             }
 
@@ -660,7 +1797,10 @@ LWMEM_PREF(realloc)(void* const ptr, const size_t size) {
      * At this stage, it was not possible to modify existing block in any possible way
      * Some manual work is required by allocating new memory and copy content to it
      */
-    retval = prv_alloc(size);                   /* Try to allocate new block */
+    retval = prv_alloc_local(prv_get_reserve_size(final_size) - LWMEM_BLOCK_META_SIZE, node);  /* Try to allocate new block with growth reserve */
+    if (retval == NULL) {
+        retval = prv_alloc_local(size, node);   /* Try to allocate new block with exact size */
+    }
     if (retval != NULL) {
         block_size = block_app_size(ptr);       /* Get application size from input pointer */
         LWMEM_MEMCPY(retval, ptr, size > block_size ? block_size : size);
@@ -669,6 +1809,41 @@ LWMEM_PREF(realloc)(void* const ptr, const size_t size) {
     return retval;
 }
 
+/**
+ * \brief           Reallocates already allocated memory with new size
+ *
+ * Function behaves differently, depends on input parameter of `ptr` and `size`:
+ *
+ *  - `ptr == NULL; size == 0`: Function returns `NULL`, no memory is allocated or freed
+ *  - `ptr == NULL; size != 0`: Function tries to allocate new block of memory with `size` length, equivalent to `malloc(size)`
+ *  - `ptr != NULL; size == 0`: Function frees memory, equivalent to `free(ptr)`
+ *  - `ptr != NULL; size != 0`: Function tries to allocate new memory of copy content before returning pointer on success
+ *
+ * \note            Function declaration is in-line with standard C function `realloc`
+ *
+ * \param[in]       ptr: Memory block previously allocated with one of allocation functions.
+ *                      It may be set to `NULL` to create new clean allocation
+ * \param[in]       size: Size of new memory to reallocate
+ * \return          Pointer to allocated memory on success, `NULL` otherwise
+ */
+void *
+LWMEM_PREF(realloc)(void* const ptr, const size_t size) {
+    void* retval;
+    size_t old_size;
+    const unsigned int node = LWMEM_CURRENT_NODE();
+    LWMEM_LATENCY_START();
+
+    LWMEM_PROTECT();
+    old_size = LWMEM_HIST_SIZE(ptr);
+    retval = prv_realloc(ptr, size, node);
+    LWMEM_HIST_RESIZE(old_size, size, retval);
+    LWMEM_LATENCY_TAKE_SEARCH();
+    LWMEM_UNPROTECT();
+    LWMEM_STATS_INC(retval != NULL || size == 0 ? LWMEM_STATS_REALLOC : LWMEM_STATS_FAILED);
+    LWMEM_LATENCY_END(LWMEM_OP_REALLOC);
+    return retval;
+}
+
 /**
  * \brief           Safe version of classic realloc function
  *
@@ -713,6 +1888,160 @@ LWMEM_PREF(realloc_s)(void** const ptr, const size_t size) {
     return new_ptr != NULL;
 }
 
+/**
+ * \brief           Get usable size of allocated memory
+ *
+ * Usable size is at least size requested at allocation time,
+ * but it may be bigger due to alignment and block splitting.
+ * Application may use complete usable size of memory
+ *
+ * \param[in]       ptr: Memory previously allocated with one of allocation functions
+ * \return          Usable size of memory in units of bytes, `0` if pointer is `NULL` or not valid
+ */
+size_t
+LWMEM_PREF(usable_size)(void* const ptr) {
+    return block_app_size(ptr);
+}
+
+/**
+ * \brief           Private function to expand allocated memory in place
+ * \param[in]       ptr: Memory previously allocated with one of allocation functions
+ * \param[in]       size: New requested size, in units of bytes
+ * \return          `1` on success, `0` otherwise
+ */
+static unsigned char
+prv_expand_in_place(void* const ptr, const size_t size) {
+    lwmem_block_t* block, *prev;
+    size_t block_size;
+
+    /* Calculate final size including meta data size */
+    const size_t final_size = LWMEM_ALIGN(size) + LWMEM_BLOCK_META_SIZE;
+
+    if (ptr == NULL || (size & LWMEM_ALLOC_BIT) || (final_size & LWMEM_ALLOC_BIT)) {
+        return 0;
+    }
+
+    block = LWMEM_GET_BLOCK_FROM_PTR(ptr);
+#if LWMEM_LARGE_MMAP_THRESHOLD > 0
+    if (LWMEM_BLOCK_IS_LARGE(block)) {
+        return size <= block_app_size(ptr) || prv_large_realloc(block, size, 0) != NULL;    /* Resize mapping without moving it */
+    }
+#endif /* LWMEM_LARGE_MMAP_THRESHOLD > 0 */
+    if (!LWMEM_BLOCK_IS_ALLOC(block)) {
+        return 0;
+    }
+    block_size = block->size & ~LWMEM_ALLOC_BIT;
+    if (final_size <= block_size) {
+        return 1;                               /* Block is already big enough */
+    }
+
+    /* Find free block before input block */
+    for (prev = &start_block; prev != NULL && prev->next < block; prev = prev->next) {}
+
+    /* Check if next free block is right after input block and big enough */
+    if ((LWMEM_TO_BYTE_PTR(block) + block_size) == LWMEM_TO_BYTE_PTR(prev->next)
+        && prev->next->size > 0                 /* Must not be end of region indicator */
+        && (block_size + prev->next->size) >= final_size) {
+        LWMEM_PURGE_SRC(src, prev->next);
+        mem_available_bytes -= prev->next->size;/* Decrease effective available bytes */
+        block->size = block_size + prev->next->size;/* Increase effective size of block */
+        prev->next = prev->next->next;          /* Remove expanded block from free list */
+
+        prv_split_too_big_block(block, final_size, 1);  /* Split block if necessary and set it as allocated */
+        LWMEM_PURGE_CARRY_NEXT(src, block);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * \brief           Expand allocated memory without moving it
+ *
+ * Function only succeeds when new size fits to existing block
+ * or when block can absorb free block physically located right after it.
+ * Memory is never moved, so pointers to allocated memory stay valid
+ *
+ * \param[in]       ptr: Memory previously allocated with one of allocation functions
+ * \param[in]       size: New requested size, in units of bytes
+ * \return          `1` if memory has at least `size` bytes available at the same address, `0` otherwise
+ */
+unsigned char
+LWMEM_PREF(expand_in_place)(void* const ptr, const size_t size) {
+    unsigned char success;
+    size_t old_size;
+    LWMEM_LATENCY_START();
+
+    LWMEM_PROTECT();
+    old_size = LWMEM_HIST_SIZE(ptr);
+    success = prv_expand_in_place(ptr, size);
+    LWMEM_HIST_RESIZE(old_size, size, success ? ptr : NULL);
+    LWMEM_UNPROTECT();
+    LWMEM_LATENCY_END(LWMEM_OP_EXPAND_IN_PLACE);
+    return success;
+}
+
+/**
+ * \brief           Private function to shrink allocated memory in place
+ * \param[in]       ptr: Memory previously allocated with one of allocation functions
+ * \param[in]       size: New requested size, in units of bytes
+ * \return          `1` on success, `0` otherwise
+ */
+static unsigned char
+prv_shrink_in_place(void* const ptr, const size_t size) {
+    lwmem_block_t* block;
+    size_t block_size;
+
+    /* Calculate final size including meta data size */
+    const size_t final_size = LWMEM_ALIGN(size) + LWMEM_BLOCK_META_SIZE;
+
+    if (ptr == NULL || size == 0 || (size & LWMEM_ALLOC_BIT) || (final_size & LWMEM_ALLOC_BIT)) {
+        return 0;
+    }
+
+    block = LWMEM_GET_BLOCK_FROM_PTR(ptr);
+#if LWMEM_LARGE_MMAP_THRESHOLD > 0
+    if (LWMEM_BLOCK_IS_LARGE(block)) {
+        return size <= block_app_size(ptr) && prv_large_realloc(block, size, 0) != NULL;
+    }
+#endif /* LWMEM_LARGE_MMAP_THRESHOLD > 0 */
+    if (!LWMEM_BLOCK_IS_ALLOC(block)) {
+        return 0;
+    }
+    block_size = block->size & ~LWMEM_ALLOC_BIT;
+    if (final_size > block_size) {
+        return 0;                               /* Cannot shrink to bigger size */
+    }
+    if (final_size < block_size) {
+        prv_shrink_block(block, block_size, final_size);
+    }
+    return 1;
+}
+
+/**
+ * \brief           Shrink allocated memory without moving it
+ *
+ * Released memory at the end of block is put back to free blocks when possible.
+ * Memory is never moved, so pointers to allocated memory stay valid
+ *
+ * \param[in]       ptr: Memory previously allocated with one of allocation functions
+ * \param[in]       size: New requested size, in units of bytes. Must be greater than `0`
+ * \return          `1` if memory has been shrunk, `0` otherwise
+ */
+unsigned char
+LWMEM_PREF(shrink_in_place)(void* const ptr, const size_t size) {
+    unsigned char success;
+    size_t old_size;
+    LWMEM_LATENCY_START();
+
+    LWMEM_PROTECT();
+    old_size = LWMEM_HIST_SIZE(ptr);
+    success = prv_shrink_in_place(ptr, size);
+    LWMEM_HIST_RESIZE(old_size, size, success ? ptr : NULL);
+    LWMEM_UNPROTECT();
+    LWMEM_LATENCY_END(LWMEM_OP_SHRINK_IN_PLACE);
+    return success;
+}
+
 /**
  * \brief           Free previously allocated memory using one of allocation functions
  * \note            Function declaration is in-line with standard C function `free`
@@ -720,7 +2049,16 @@ LWMEM_PREF(realloc_s)(void** const ptr, const size_t size) {
  */
 void
 LWMEM_PREF(free)(void* const ptr) {
+    LWMEM_LATENCY_START();
+
+    LWMEM_PROTECT();
+    LWMEM_HIST_FREE(ptr);
     prv_free(ptr);                              /* Free pointer */
+    LWMEM_UNPROTECT();
+    if (ptr != NULL) {
+        LWMEM_STATS_INC(LWMEM_STATS_FREE);
+    }
+    LWMEM_LATENCY_END(LWMEM_OP_FREE);
 }
 
 /**
@@ -742,3 +2080,724 @@ LWMEM_PREF(free_s)(void** const ptr) {
         *ptr = NULL;
     }
 }
+
+/**
+ * \brief           Walk through all blocks of all regions in address order
+ *
+ * Callback function is called for every allocated and free block, with its information.
+ * Blocks allocated in their own memory mappings with \ref LWMEM_LARGE_MMAP_THRESHOLD are not reported.
+ *
+ * \note            Heap is locked during walk and callback function must not call memory manager functions
+ * \param[in]       fn: Callback function. It returns `1` to continue walk or `0` to stop it
+ * \param[in]       arg: Custom user argument passed to callback function
+ * \return          Number of visited blocks
+ */
+size_t
+LWMEM_PREF(walk)(LWMEM_PREF(walk_fn) fn, void* const arg) {
+    LWMEM_PREF(block_info_t) info;
+    lwmem_region_trailer_t* trailer;
+    lwmem_block_t* block;
+    size_t size, count = 0;
+
+    if (fn == NULL) {
+        return 0;
+    }
+    LWMEM_PROTECT();
+    info.region = 0;
+    for (trailer = first_trailer; trailer != NULL; trailer = trailer->next, info.region++) {
+        for (block = trailer->first_block; block < &trailer->block; block = (void *)(LWMEM_TO_BYTE_PTR(block) + size)) {
+            size = block->size & ~LWMEM_ALLOC_BIT;
+            if (size < LWMEM_BLOCK_META_SIZE    /* Stop on corrupted block, which would not advance walk */
+                || size > (size_t)(LWMEM_TO_BYTE_PTR(&trailer->block) - LWMEM_TO_BYTE_PTR(block))) {
+                break;
+            }
+            info.ptr = LWMEM_TO_BYTE_PTR(block) + LWMEM_BLOCK_META_SIZE;
+            info.size = size - LWMEM_BLOCK_META_SIZE;
+            info.allocated = LWMEM_BLOCK_IS_ALLOC(block);
+            count++;
+            if (!fn(&info, arg)) {
+                LWMEM_UNPROTECT();
+                return count;
+            }
+        }
+    }
+    LWMEM_UNPROTECT();
+    return count;
+}
+
+/**
+ * \brief           Check list of free blocks
+ * \return          `1` when list is consistent, `0` otherwise
+ */
+static unsigned char
+prv_check_free_list(void) {
+    lwmem_block_t* block;
+    size_t available = 0, regions = 0;
+
+    for (block = start_block.next; block != NULL; block = block->next) {
+        if (block->next != NULL && block->next <= block) {
+            return 0;                           /* List must be strictly address ordered */
+        }
+        if (block->size == 0) {                 /* End of region indication */
+            regions++;
+            continue;
+        }
+        if ((block->size & LWMEM_ALLOC_BIT) || block->size < LWMEM_BLOCK_MIN_SIZE || block->next == NULL) {
+            return 0;                           /* Free block is followed by at least end of its region */
+        }
+        if (LWMEM_TO_BYTE_PTR(block) + block->size > LWMEM_TO_BYTE_PTR(block->next)
+            || (LWMEM_TO_BYTE_PTR(block) + block->size == LWMEM_TO_BYTE_PTR(block->next) && block->next->size != 0)) {
+            return 0;                           /* Blocks overlap or are not merged */
+        }
+        available += block->size;
+    }
+    return available == mem_available_bytes && regions == mem_regions_count
+        && (end_block == NULL || (end_block->size == 0 && end_block->next == NULL));
+}
+
+/**
+ * \brief           Check physical layout of all regions against list of free blocks
+ * \return          `1` when layout is consistent, `0` otherwise
+ */
+static unsigned char
+prv_check_regions(void) {
+    lwmem_region_trailer_t* trailer;
+    lwmem_block_t* block, *free_block = start_block.next;
+    size_t size, available = 0, regions = 0;
+
+    for (trailer = first_trailer; trailer != NULL; trailer = trailer->next, regions++) {
+        for (block = trailer->first_block; block < &trailer->block; block = (void *)(LWMEM_TO_BYTE_PTR(block) + size)) {
+            size = block->size & ~LWMEM_ALLOC_BIT;
+            if (size < LWMEM_BLOCK_MIN_SIZE
+                || size > (size_t)(LWMEM_TO_BYTE_PTR(&trailer->block) - LWMEM_TO_BYTE_PTR(block))) {
+                return 0;                       /* Block must be within its region */
+            }
+            if (block->size & LWMEM_ALLOC_BIT) {
+                if (!LWMEM_BLOCK_IS_ALLOC(block)) {
+                    return 0;                   /* Allocated block must have marker */
+                }
+            } else if (block != free_block) {
+                return 0;                       /* Free block must be next in list of free blocks */
+            } else {
+                available += size;
+                free_block = free_block->next;
+            }
+        }
+        if (block != &trailer->block || free_block != block) {
+            return 0;                           /* Blocks must tile region up to its end block */
+        }
+        free_block = free_block->next;
+    }
+    return free_block == NULL && available == mem_available_bytes && regions == mem_regions_count;
+}
+
+/**
+ * \brief           Check consistency of memory manager
+ *
+ * Function is used to detect memory corruption, for example writes out of allocated memory bounds,
+ * close to the place where it happened rather than later in allocation functions.
+ *
+ * Fast check verifies list of free blocks: address order, merged neighbours, sizes,
+ * number of available bytes and end of region indications.
+ * Its time is proportional to number of free blocks and it may be called periodically in production.
+ *
+ * Thorough check additionally walks through all blocks of all regions
+ * and verifies that each allocated block has allocation marker
+ * and each free block is in list of free blocks.
+ * Its time is proportional to number of all blocks.
+ *
+ * \param[in]       mode: Check mode, \ref LWMEM_CHECK_FAST or \ref LWMEM_CHECK_THOROUGH
+ * \return          `1` when memory manager is consistent, `0` when corruption is detected
+ */
+unsigned char
+LWMEM_PREF(check)(const LWMEM_PREF(check_mode_t) mode) {
+    unsigned char ok;
+
+    LWMEM_PROTECT();
+    ok = prv_check_free_list();
+    if (ok && mode == LWMEM_CHECK_THOROUGH) {
+        ok = prv_check_regions();
+    }
+    LWMEM_UNPROTECT();
+    return ok;
+}
+
+#if LWMEM_PURGE || __DOXYGEN__
+
+/**
+ * \brief           Return memory of unused free blocks to operating system
+ *
+ * Function is called periodically by application, for example once per second.
+ * Free blocks unused for \ref LWMEM_PURGE_DECAY calls get their page aligned interior released,
+ * while block header stays intact and block remains available for allocation.
+ *
+ * \param[in]       all: Set to `1` to purge all free blocks regardless of their age
+ * \return          Number of bytes returned to operating system
+ */
+size_t
+LWMEM_PREF(purge)(const unsigned char all) {
+    const size_t page_size = prv_get_page_size();
+    lwmem_purge_info_t* info;
+    lwmem_block_t* block;
+    const unsigned char* start;
+    size_t len, purged = 0;
+
+    LWMEM_PROTECT();
+    purge_epoch++;
+    for (block = start_block.next; block != NULL; block = block->next) {
+        if (block->size < LWMEM_BLOCK_META_SIZE + sizeof(lwmem_purge_info_t) + page_size) {
+            continue;                           /* Too small to contain complete page */
+        }
+        info = LWMEM_PURGE_INFO(block);
+        if (!LWMEM_PURGE_IS_VALID(block)) {     /* Block was modified, start its decay now */
+            info->tag = LWMEM_PURGE_TAG(block);
+            info->epoch = purge_epoch;
+            info->clean = 0;
+        }
+        if (!all && purge_epoch - info->epoch < LWMEM_PURGE_DECAY) {
+            continue;
+        }
+
+        /* Release pages after purge information, up to next block */
+        len = prv_purge_range(LWMEM_TO_BYTE_PTR(block), block->size, &start);
+        if (len > 0 && info->clean < len && madvise((void *)start, len, LWMEM_PURGE_ADVICE) == 0) {
+            purged += len - info->clean;
+            info->clean = len;
+        }
+    }
+    LWMEM_UNPROTECT();
+    return purged;
+}
+
+#endif /* LWMEM_PURGE || __DOXYGEN__ */
+
+/**
+ * \brief           Get memory manager statistics
+ *
+ * Size of free memory returned to operating system is counted by walking through list of free blocks.
+ * Allocation counters are summed from slots of all threads, when enabled with \ref LWMEM_STATS
+ *
+ * \param[out]      stats: Output statistics
+ */
+void
+LWMEM_PREF(get_stats)(LWMEM_PREF(stats_t)* const stats) {
+    lwmem_region_trailer_t* trailer;
+#if LWMEM_STATS
+    size_t i;
+#endif /* LWMEM_STATS */
+#if LWMEM_PURGE
+    lwmem_block_t* block;
+#endif /* LWMEM_PURGE */
+
+    if (stats == NULL) {
+        return;
+    }
+    LWMEM_PROTECT();
+    stats->mem_size_bytes = 0;
+    for (trailer = first_trailer; trailer != NULL; trailer = trailer->next) {
+        stats->mem_size_bytes += (size_t)(LWMEM_TO_BYTE_PTR(&trailer->block) - LWMEM_TO_BYTE_PTR(trailer->first_block));
+    }
+    stats->mem_available_bytes = mem_available_bytes;
+    stats->clean_bytes = 0;
+#if LWMEM_PURGE
+    for (block = start_block.next; block != NULL; block = block->next) {
+        if (block->size > 0 && LWMEM_PURGE_IS_VALID(block)) {
+            stats->clean_bytes += LWMEM_PURGE_INFO(block)->clean;
+        }
+    }
+#endif /* LWMEM_PURGE */
+    stats->dirty_bytes = stats->mem_available_bytes - stats->clean_bytes;
+    LWMEM_UNPROTECT();
+
+    /* Counters are not protected by mutex and are read without blocking allocations */
+    stats->alloc_count = stats->free_count = stats->realloc_count = stats->failed_count = 0;
+#if LWMEM_STATS
+    for (i = 0; i < LWMEM_STATS_SLOTS; ++i) {
+        stats->alloc_count += LWMEM_STATS_READ(stats_slots[i].cnt[LWMEM_STATS_ALLOC]);
+        stats->free_count += LWMEM_STATS_READ(stats_slots[i].cnt[LWMEM_STATS_FREE]);
+        stats->realloc_count += LWMEM_STATS_READ(stats_slots[i].cnt[LWMEM_STATS_REALLOC]);
+        stats->failed_count += LWMEM_STATS_READ(stats_slots[i].cnt[LWMEM_STATS_FAILED]);
+    }
+#endif /* LWMEM_STATS */
+}
+
+#if LWMEM_HISTOGRAM || __DOXYGEN__
+
+/**
+ * \brief           Get allocation size histogram
+ *
+ * Allocation requests are counted in bucket of requested size,
+ * while allocated and freed blocks are counted in bucket of their usable size.
+ * They are the same bucket, except when block got extra memory from splitting or reallocation reserve.
+ * Reallocation is counted as free of old block and allocation of new one.
+ * Histogram is not changed by \ref lwmem_restore function
+ *
+ * \param[out]      buckets: Output array of buckets. Set to `NULL` to get number of buckets only
+ * \param[in]       len: Length of output array
+ * \return          Number of buckets up to the last used one, which may be more than `len`
+ */
+size_t
+LWMEM_PREF(histogram)(LWMEM_PREF(hist_bucket_t)* const buckets, const size_t len) {
+    size_t i, used = 0;
+
+    LWMEM_PROTECT();
+    for (i = 0; i < LWMEM_HIST_BUCKETS; ++i) {
+        if (hist[i].requests > 0 || hist[i].allocated > 0 || hist[i].freed > 0) {
+            used = i + 1;
+        }
+    }
+    for (i = 0; buckets != NULL && i < used && i < len; ++i) {
+        buckets[i].size = prv_hist_bucket_size(i);
+        buckets[i].requests = hist[i].requests;
+        buckets[i].allocated = hist[i].allocated;
+        buckets[i].freed = hist[i].freed;
+        buckets[i].live = hist[i].allocated > hist[i].freed ? hist[i].allocated - hist[i].freed : 0;
+    }
+    LWMEM_UNPROTECT();
+    return used;
+}
+
+/**
+ * \brief           Print allocation size histogram to text buffer
+ *
+ * Only buckets with non-zero counters are printed.
+ * Text format is table with header line and one line per bucket.
+ * JSON format is object with `buckets` array, with bucket objects of \ref lwmem_hist_bucket_t fields
+ *
+ * \param[out]      buf: Output buffer, always terminated with `0` when `size` is greater than `0`.
+ *                      Set to `NULL` to get required length only
+ * \param[in]       size: Size of output buffer in units of bytes
+ * \param[in]       format: Output format
+ * \return          Length of complete output, without terminating `0`.
+ *                      Output is truncated when it is not less than `size`
+ */
+size_t
+LWMEM_PREF(histogram_dump)(char* const buf, const size_t size, const LWMEM_PREF(dump_format_t) format) {
+    LWMEM_PREF(hist_bucket_t) b;
+    size_t i, len = 0;
+    unsigned char first = 1;
+    int n;
+
+/* Append formatted text to output buffer, at most its remaining size */
+#define LWMEM_DUMP_PRINT(...)   do {                                    \
+    n = snprintf(buf != NULL && len < size ? buf + len : NULL,          \
+                    buf != NULL && len < size ? size - len : 0, __VA_ARGS__);   \
+    len += n > 0 ? (size_t)n : 0;                                       \
+} while (0)
+
+    if (format == LWMEM_DUMP_JSON) {
+        LWMEM_DUMP_PRINT("{\"buckets\":[");
+    } else {
+        LWMEM_DUMP_PRINT("%12s %12s %12s %12s %12s\n", "size", "requests", "allocated", "freed", "live");
+    }
+    LWMEM_PROTECT();                            /* Keep counters consistent while printing */
+    for (i = 0; i < LWMEM_HIST_BUCKETS; ++i) {
+        b.size = prv_hist_bucket_size(i);
+        b.requests = hist[i].requests;
+        b.allocated = hist[i].allocated;
+        b.freed = hist[i].freed;
+        if (b.requests == 0 && b.allocated == 0 && b.freed == 0) {
+            continue;
+        }
+        b.live = b.allocated > b.freed ? b.allocated - b.freed : 0;
+        if (format == LWMEM_DUMP_JSON) {
+            LWMEM_DUMP_PRINT("%s{\"size\":%zu,\"requests\":%zu,\"allocated\":%zu,\"freed\":%zu,\"live\":%zu}",
+                                first ? "" : ",", b.size, b.requests, b.allocated, b.freed, b.live);
+        } else {
+            LWMEM_DUMP_PRINT("%12zu %12zu %12zu %12zu %12zu\n", b.size, b.requests, b.allocated, b.freed, b.live);
+        }
+        first = 0;
+    }
+    LWMEM_UNPROTECT();
+    if (format == LWMEM_DUMP_JSON) {
+        LWMEM_DUMP_PRINT("]}");
+    }
+#undef LWMEM_DUMP_PRINT
+    return len;
+}
+
+#endif /* LWMEM_HISTOGRAM || __DOXYGEN__ */
+
+#if LWMEM_LATENCY || __DOXYGEN__
+
+/**
+ * \brief           Get number of values in latency histogram bucket, summed over all slots
+ * \param[in]       op: Operation
+ * \param[in]       bucket: Bucket index
+ * \return          Number of values in bucket
+ */
+static uint64_t
+prv_latency_bucket_count(const LWMEM_PREF(op_t) op, const size_t bucket) {
+    uint64_t count = 0;
+    size_t i;
+
+    for (i = 0; i < LWMEM_STATS_SLOTS; ++i) {
+        count += LWMEM_STATS_READ(latency_slots[i].op[op].buckets[bucket]);
+    }
+    return count;
+}
+
+/**
+ * \brief           Get value at percentile of latency histogram
+ * \param[in]       op: Operation
+ * \param[in]       count: Number of values in histogram
+ * \param[in]       permyriad: Percentile in units of `0.01` percent, from `1` to `10000`
+ * \return          Biggest value of bucket, which contains value at percentile
+ */
+static uint64_t
+prv_latency_percentile(const LWMEM_PREF(op_t) op, const uint64_t count, const uint64_t permyriad) {
+    const uint64_t rank = (count * permyriad + 9999) / 10000;
+    uint64_t seen = 0;
+    size_t i;
+
+    for (i = 0; i < LWMEM_LATENCY_BUCKETS; ++i) {
+        seen += prv_latency_bucket_count(op, i);
+        if (seen >= rank && seen > 0) {
+            return prv_latency_bucket_value(i);
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief           Get latency summary of operation
+ *
+ * Latency of public function is measured in processor cycles, from its entry to its return,
+ * including wait for memory manager protection. Percentiles are reported as biggest value of histogram bucket,
+ * with relative precision set by \ref LWMEM_LATENCY_SUB_BITS.
+ * Summary of \ref LWMEM_OP_SEARCH reports number of free list nodes visited per allocation instead of cycles.
+ * Each thread counts values in its own slot, slots are summed here
+ *
+ * \param[in]       op: Operation
+ * \param[out]      latency: Output summary
+ */
+void
+LWMEM_PREF(latency)(const LWMEM_PREF(op_t) op, LWMEM_PREF(latency_t)* const latency) {
+    uint64_t sum = 0;
+    size_t i;
+
+    if (latency == NULL || op >= LWMEM_OP_COUNT) {
+        return;
+    }
+    latency->count = 0;
+    for (i = 0; i < LWMEM_STATS_SLOTS; ++i) {
+        latency->count += LWMEM_STATS_READ(latency_slots[i].op[op].count);
+        sum += LWMEM_STATS_READ(latency_slots[i].op[op].sum);
+    }
+    latency->mean = latency->count > 0 ? sum / latency->count : 0;
+    latency->p50 = prv_latency_percentile(op, latency->count, 5000);
+    latency->p90 = prv_latency_percentile(op, latency->count, 9000);
+    latency->p99 = prv_latency_percentile(op, latency->count, 9900);
+    latency->p999 = prv_latency_percentile(op, latency->count, 9990);
+    latency->max = 0;
+    for (i = LWMEM_LATENCY_BUCKETS; i > 0; --i) {
+        if (prv_latency_bucket_count(op, i - 1) > 0) {
+            latency->max = prv_latency_bucket_value(i - 1);
+            break;
+        }
+    }
+}
+
+/**
+ * \brief           Reset latency histograms of all operations
+ * \note            Values counted by other threads during reset may be lost
+ */
+void
+LWMEM_PREF(latency_reset)(void) {
+    LWMEM_MEMSET(latency_slots, 0x00, sizeof(latency_slots));
+}
+
+/**
+ * \brief           Print latency summaries of all operations to text buffer
+ *
+ * Operations without measurements are not printed.
+ * Text format is table with header line and one line per operation.
+ * JSON format is object with operation names as keys and summary objects of \ref lwmem_latency_t fields as values
+ *
+ * \param[out]      buf: Output buffer, always terminated with `0` when `size` is greater than `0`.
+ *                      Set to `NULL` to get required length only
+ * \param[in]       size: Size of output buffer in units of bytes
+ * \param[in]       format: Output format
+ * \return          Length of complete output, without terminating `0`.
+ *                      Output is truncated when it is not less than `size`
+ */
+size_t
+LWMEM_PREF(latency_dump)(char* const buf, const size_t size, const LWMEM_PREF(dump_format_t) format) {
+    static const char* const names[] = {
+        "malloc", "malloc_aligned", "malloc_node", "calloc", "realloc",
+        "expand_in_place", "shrink_in_place", "free", "search_nodes",
+    };
+    LWMEM_PREF(latency_t) l;
+    LWMEM_PREF(op_t) op;
+    size_t len = 0;
+    unsigned char first = 1;
+    int n;
+
+/* Append formatted text to output buffer, at most its remaining size */
+#define LWMEM_DUMP_PRINT(...)   do {                                    \
+    n = snprintf(buf != NULL && len < size ? buf + len : NULL,          \
+                    buf != NULL && len < size ? size - len : 0, __VA_ARGS__);   \
+    len += n > 0 ? (size_t)n : 0;                                       \
+} while (0)
+
+    if (format == LWMEM_DUMP_JSON) {
+        LWMEM_DUMP_PRINT("{");
+    } else {
+        LWMEM_DUMP_PRINT("%-16s %12s %12s %12s %12s %12s %12s %12s\n",
+                            "operation", "count", "mean", "p50", "p90", "p99", "p99.9", "max");
+    }
+    for (op = (LWMEM_PREF(op_t))0; op < LWMEM_OP_COUNT; op = (LWMEM_PREF(op_t))(op + 1)) {
+        LWMEM_PREF(latency)(op, &l);
+        if (l.count == 0) {
+            continue;
+        }
+        if (format == LWMEM_DUMP_JSON) {
+            LWMEM_DUMP_PRINT("%s\"%s\":{\"count\":%llu,\"mean\":%llu,\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"p999\":%llu,\"max\":%llu}",
+                                first ? "" : ",", names[op], (unsigned long long)l.count, (unsigned long long)l.mean,
+                                (unsigned long long)l.p50, (unsigned long long)l.p90, (unsigned long long)l.p99,
+                                (unsigned long long)l.p999, (unsigned long long)l.max);
+        } else {
+            LWMEM_DUMP_PRINT("%-16s %12llu %12llu %12llu %12llu %12llu %12llu %12llu\n",
+                                names[op], (unsigned long long)l.count, (unsigned long long)l.mean,
+                                (unsigned long long)l.p50, (unsigned long long)l.p90, (unsigned long long)l.p99,
+                                (unsigned long long)l.p999, (unsigned long long)l.max);
+        }
+        first = 0;
+    }
+    if (format == LWMEM_DUMP_JSON) {
+        LWMEM_DUMP_PRINT("}");
+    }
+#undef LWMEM_DUMP_PRINT
+    return len;
+}
+
+#endif /* LWMEM_LATENCY || __DOXYGEN__ */
+
+/**
+ * \brief           Snapshot identification, `LWSN` in ASCII
+ */
+#define LWMEM_SNAPSHOT_MAGIC            ((size_t)0x4E53574C)
+
+/**
+ * \brief           Snapshot header
+ *
+ * Header is followed by description of each region: \ref lwmem_snapshot_region_t structure
+ * and sizes of all region blocks, each followed by application data when block is allocated
+ */
+typedef struct {
+    size_t magic;                               /*!< Snapshot identification */
+    size_t regions;                             /*!< Number of regions */
+    size_t available;                           /*!< Memory size available for allocation */
+} lwmem_snapshot_header_t;
+
+/**
+ * \brief           Region description in snapshot
+ */
+typedef struct {
+    void* first_block;                          /*!< Address of region first block */
+    size_t blocks;                              /*!< Number of blocks in region */
+} lwmem_snapshot_region_t;
+
+/**
+ * \brief           Write data to snapshot buffer
+ * \param[in]       buf: Output buffer, `NULL` to only calculate size
+ * \param[in]       pos: Write position in buffer
+ * \param[in]       cap: Buffer capacity
+ * \param[in]       data: Data to write
+ * \param[in]       len: Data length in units of bytes
+ * \return          Position after written data, `0` if buffer is too small
+ */
+static size_t
+prv_snapshot_write(void* const buf, const size_t pos, const size_t cap, const void* const data, const size_t len) {
+    if (buf != NULL) {
+        if (len > cap - pos) {
+            return 0;
+        }
+        LWMEM_MEMCPY(LWMEM_TO_BYTE_PTR(buf) + pos, data, len);
+    }
+    return pos + len;
+}
+
+/**
+ * \brief           Save memory manager state and application data of allocated blocks to buffer
+ *
+ * Snapshot contains physical layout of all blocks in all regions,
+ * with data of allocated blocks only, while free memory is skipped.
+ * Blocks allocated in their own memory mappings with \ref LWMEM_LARGE_MMAP_THRESHOLD are not saved.
+ *
+ * \param[out]      out_buf: Output buffer. Set to `NULL` to get required buffer size
+ * \param[in]       size: Size of output buffer in units of bytes
+ * \return          Number of bytes written (or required when buffer is `NULL`),
+ *                  `0` when buffer is too small or block sizes in region are corrupted
+ */
+size_t
+LWMEM_PREF(snapshot)(void* const out_buf, const size_t size) {
+    lwmem_snapshot_header_t hdr;
+    lwmem_snapshot_region_t reg;
+    lwmem_region_trailer_t* trailer;
+    lwmem_block_t* block;
+    size_t pos, bsize;
+
+    LWMEM_PROTECT();
+    hdr.magic = LWMEM_SNAPSHOT_MAGIC;
+    hdr.regions = mem_regions_count;
+    hdr.available = mem_available_bytes;
+    pos = prv_snapshot_write(out_buf, 0, size, &hdr, sizeof(hdr));
+    for (trailer = first_trailer; trailer != NULL && pos > 0; trailer = trailer->next) {
+        reg.first_block = trailer->first_block;
+        reg.blocks = 0;
+        for (block = trailer->first_block; block < &trailer->block;
+            block = (void *)(LWMEM_TO_BYTE_PTR(block) + (block->size & ~LWMEM_ALLOC_BIT))) {
+            bsize = block->size & ~LWMEM_ALLOC_BIT;
+            if (bsize < LWMEM_BLOCK_MIN_SIZE || (bsize & LWMEM_ALIGN_BITS)
+                || bsize > (size_t)(LWMEM_TO_BYTE_PTR(&trailer->block) - LWMEM_TO_BYTE_PTR(block))) {
+                pos = 0;                        /* Corrupted block, do not walk past region */
+                break;
+            }
+            reg.blocks++;
+        }
+        if (pos == 0) {
+            break;
+        }
+        pos = prv_snapshot_write(out_buf, pos, size, &reg, sizeof(reg));
+        for (block = trailer->first_block; block < &trailer->block && pos > 0;
+            block = (void *)(LWMEM_TO_BYTE_PTR(block) + (block->size & ~LWMEM_ALLOC_BIT))) {
+            pos = prv_snapshot_write(out_buf, pos, size, &block->size, sizeof(block->size));
+            if (pos > 0 && (block->size & LWMEM_ALLOC_BIT)) {
+                pos = prv_snapshot_write(out_buf, pos, size, LWMEM_TO_BYTE_PTR(block) + LWMEM_BLOCK_META_SIZE,
+                    (block->size & ~LWMEM_ALLOC_BIT) - LWMEM_BLOCK_META_SIZE);
+            }
+        }
+    }
+    LWMEM_UNPROTECT();
+    return pos;
+}
+
+/**
+ * \brief           Check snapshot against assigned regions, or restore it
+ * \param[in]       in_buf: Snapshot buffer
+ * \param[in]       size: Snapshot size in units of bytes
+ * \param[in]       apply: Set to `0` to check snapshot only, or `1` to restore it
+ * \return          `1` when snapshot is valid, `0` otherwise
+ */
+static unsigned char
+prv_restore(const void* const in_buf, const size_t size, const unsigned char apply) {
+    const unsigned char* data = in_buf;
+    lwmem_snapshot_header_t hdr;
+    lwmem_snapshot_region_t reg;
+    lwmem_region_trailer_t* trailer;
+    lwmem_block_t* block, *prev = &start_block;
+    size_t pos = sizeof(hdr), bsize, app_size, available = 0;
+
+    if (size < sizeof(hdr)) {
+        return 0;
+    }
+    LWMEM_MEMCPY(&hdr, data, sizeof(hdr));
+    if (hdr.magic != LWMEM_SNAPSHOT_MAGIC || hdr.regions != mem_regions_count) {
+        return 0;
+    }
+    for (trailer = first_trailer; trailer != NULL; trailer = trailer->next) {
+        if (size - pos < sizeof(reg)) {
+            return 0;
+        }
+        LWMEM_MEMCPY(&reg, data + pos, sizeof(reg));
+        pos += sizeof(reg);
+        if (reg.first_block != trailer->first_block) {
+            return 0;                           /* Regions must be the same as at snapshot time */
+        }
+        block = trailer->first_block;
+        for (; reg.blocks > 0; reg.blocks--) {
+            if (size - pos < sizeof(bsize)) {
+                return 0;
+            }
+            LWMEM_MEMCPY(&bsize, data + pos, sizeof(bsize));
+            pos += sizeof(bsize);
+            app_size = (bsize & ~LWMEM_ALLOC_BIT) - LWMEM_BLOCK_META_SIZE;
+            if ((bsize & ~LWMEM_ALLOC_BIT) < LWMEM_BLOCK_MIN_SIZE || (bsize & LWMEM_ALIGN_BITS)
+                || (bsize & ~LWMEM_ALLOC_BIT) > (size_t)(LWMEM_TO_BYTE_PTR(&trailer->block) - LWMEM_TO_BYTE_PTR(block))
+                || ((bsize & LWMEM_ALLOC_BIT) && size - pos < app_size)) {
+                return 0;
+            }
+            if (apply) {
+                block->size = bsize;
+                if (bsize & LWMEM_ALLOC_BIT) {
+                    block->next = (void *)0xDEADBEEF;
+                    LWMEM_MEMCPY(LWMEM_TO_BYTE_PTR(block) + LWMEM_BLOCK_META_SIZE, data + pos, app_size);
+                } else {
+                    prev->next = block;         /* Free blocks are linked in address order */
+                    prev = block;
+                }
+            }
+            if (bsize & LWMEM_ALLOC_BIT) {
+                pos += app_size;
+            } else {
+                available += bsize;
+            }
+            block = (void *)(LWMEM_TO_BYTE_PTR(block) + (bsize & ~LWMEM_ALLOC_BIT));
+        }
+        if (block != &trailer->block) {
+            return 0;                           /* Blocks must cover complete region */
+        }
+        if (apply) {
+            prev->next = &trailer->block;       /* End of region indication follows region free blocks */
+            prev = &trailer->block;
+        }
+    }
+    if (apply) {
+        prev->next = NULL;
+        mem_available_bytes = available;
+    }
+    return pos == size && available == hdr.available;
+}
+
+/**
+ * \brief           Restore memory manager state and application data from snapshot
+ *
+ * Snapshot must be created with \ref lwmem_snapshot in the same application,
+ * with the same regions assigned to memory manager.
+ * Snapshot is checked completely before memory manager is modified.
+ * Memory allocated after snapshot was taken is released and pointers to it must not be used.
+ *
+ * \param[in]       in_buf: Snapshot buffer
+ * \param[in]       size: Snapshot size in units of bytes, as returned by \ref lwmem_snapshot
+ * \return          `1` on success, `0` otherwise
+ */
+unsigned char
+LWMEM_PREF(restore)(const void* const in_buf, const size_t size) {
+    unsigned char ok;
+
+    if (in_buf == NULL) {
+        return 0;
+    }
+    LWMEM_PROTECT();
+    ok = prv_restore(in_buf, size, 0);
+    if (ok) {
+        ok = prv_restore(in_buf, size, 1);
+    }
+    LWMEM_UNPROTECT();
+    return ok;
+}
+
+#if LWMEM_THREAD_SAFE || __DOXYGEN__
+
+/**
+ * \brief           Lock memory manager for exclusive access
+ *
+ * Memory manager functions called by other threads wait until \ref lwmem_unlock is called.
+ * It is used to keep heap consistent during `fork`, with lock taken before and released after it.
+ * Memory manager functions must not be called by locking thread until heap is unlocked
+ */
+void
+LWMEM_PREF(lock)(void) {
+    LWMEM_PROTECT();
+}
+
+/**
+ * \brief           Unlock memory manager, previously locked with \ref lwmem_lock
+ */
+void
+LWMEM_PREF(unlock)(void) {
+    LWMEM_UNPROTECT();
+}
+
+#endif /* LWMEM_THREAD_SAFE || __DOXYGEN__ */
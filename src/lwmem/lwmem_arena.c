@@ -0,0 +1,180 @@
+/**
+ * \file            lwmem_arena.c
+ * \brief           Arena allocator on top of lightweight dynamic memory manager
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#include "lwmem/lwmem_arena.h"
+
+/* --- Memory unique part starts --- */
+/**
+ * \brief           Memory function/typedef prefix string
+ */
+#define LWMEM_PREF(x)                   lwmem_ ## x
+
+/**
+ * \brief           Alignment of arena allocations when `0` is passed as alignment
+ */
+#define LWMEM_ARENA_ALIGN_DEFAULT       (sizeof(void *) > sizeof(double) ? sizeof(void *) : sizeof(double))
+/* --- Memory unique part ends --- */
+
+/**
+ * \brief           Cast input pointer to byte
+ */
+#define LWMEM_TO_BYTE_PTR(_p_)          ((unsigned char *)(_p_))
+
+/**
+ * \brief           Chained arena chunk, allocated when current chunk is full
+ *
+ * Chunk data follows header structure
+ */
+typedef struct lwmem_arena_chunk {
+    struct lwmem_arena_chunk* next;             /*!< Previously chained chunk, `NULL` for last chunk in chain */
+} lwmem_arena_chunk_t;
+
+/**
+ * \brief           Arena structure
+ *
+ * First arena chunk data follows arena structure in the same heap block
+ */
+struct LWMEM_PREF(arena) {
+    lwmem_arena_chunk_t* chunks;                /*!< Chained chunks, most recent first. `NULL` when only first chunk is used */
+    unsigned char* ptr;                         /*!< Next free byte in current chunk */
+    unsigned char* end;                         /*!< End of current chunk */
+    size_t size;                                /*!< Arena size, used as minimal size of chained chunks */
+};
+
+/**
+ * \brief           Create new arena with first chunk taken from heap
+ * \param[in]       size: Size of first chunk in units of bytes.
+ *                      It is used as minimal size of chunks chained later, when arena gets full
+ * \return          Arena handle on success, `NULL` otherwise
+ */
+LWMEM_PREF(arena_t)*
+LWMEM_PREF(arena_create)(const size_t size) {
+    LWMEM_PREF(arena_t)* arena;
+    size_t actual;
+
+    if (size == 0 || (sizeof(*arena) + size) < size) {
+        return NULL;
+    }
+
+    /* Arena structure and first chunk data are in one block */
+    if ((arena = LWMEM_PREF(malloc_at_least)(sizeof(*arena) + size, &actual)) != NULL) {
+        arena->chunks = NULL;
+        arena->ptr = LWMEM_TO_BYTE_PTR(arena + 1);
+        arena->end = LWMEM_TO_BYTE_PTR(arena) + actual; /* Use complete usable size of block */
+        arena->size = size;
+    }
+    return arena;
+}
+
+/**
+ * \brief           Allocate memory from arena
+ *
+ * Memory is allocated by moving pointer in current chunk.
+ * When chunk is full, new chunk is taken from heap and chained to arena
+ *
+ * \param[in]       arena: Arena handle
+ * \param[in]       size: Number of bytes to allocate
+ * \param[in]       alignment: Alignment of allocated memory, must be power of `2`.
+ *                      Set to `0` to use default alignment, suitable for pointers and `double` type
+ * \return          Pointer to allocated memory on success, `NULL` otherwise
+ */
+void *
+LWMEM_PREF(arena_alloc)(LWMEM_PREF(arena_t)* const arena, const size_t size, const size_t alignment) {
+    lwmem_arena_chunk_t* chunk;
+    size_t pad, chunk_size, actual;
+    const size_t align = alignment != 0 ? alignment : LWMEM_ARENA_ALIGN_DEFAULT;
+
+    if (arena == NULL || size == 0 || (align & (align - 1))) {  /* Alignment must be power of 2 */
+        return NULL;
+    }
+
+    /* Check if current chunk has enough memory, including padding for alignment */
+    pad = (align - ((size_t)arena->ptr & (align - 1))) & (align - 1);
+    if (pad > (size_t)(arena->end - arena->ptr) || size > (size_t)(arena->end - arena->ptr) - pad) {
+        /*
+         * Current chunk is full, chain new one
+         * It must be big enough for requested size at any alignment
+         */
+        chunk_size = size + align - 1;
+        if (chunk_size < arena->size) {
+            chunk_size = arena->size;
+        }
+        if (chunk_size < size || (sizeof(*chunk) + chunk_size) < chunk_size) {
+            return NULL;
+        }
+        if ((chunk = LWMEM_PREF(malloc_at_least)(sizeof(*chunk) + chunk_size, &actual)) == NULL) {
+            return NULL;
+        }
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+        arena->ptr = LWMEM_TO_BYTE_PTR(chunk + 1);
+        arena->end = LWMEM_TO_BYTE_PTR(chunk) + actual;
+        pad = (align - ((size_t)arena->ptr & (align - 1))) & (align - 1);
+    }
+
+    arena->ptr += pad + size;                   /* Bump pointer */
+    return arena->ptr - size;
+}
+
+/**
+ * \brief           Release all allocations of arena at once
+ *
+ * Chained chunks are returned to heap, while first chunk is kept for next allocations
+ *
+ * \param[in]       arena: Arena handle
+ */
+void
+LWMEM_PREF(arena_reset)(LWMEM_PREF(arena_t)* const arena) {
+    lwmem_arena_chunk_t* chunk;
+
+    if (arena == NULL) {
+        return;
+    }
+    while ((chunk = arena->chunks) != NULL) {
+        arena->chunks = chunk->next;
+        LWMEM_PREF(free)(chunk);
+    }
+    arena->ptr = LWMEM_TO_BYTE_PTR(arena + 1);
+    arena->end = LWMEM_TO_BYTE_PTR(arena) + LWMEM_PREF(usable_size)(arena);
+}
+
+/**
+ * \brief           Release all allocations of arena and return arena memory to heap
+ * \param[in]       arena: Arena handle. It must not be used after this call
+ */
+void
+LWMEM_PREF(arena_destroy)(LWMEM_PREF(arena_t)* const arena) {
+    if (arena != NULL) {
+        LWMEM_PREF(arena_reset)(arena);         /* Release chained chunks */
+        LWMEM_PREF(free)(arena);                /* Release arena with first chunk */
+    }
+}
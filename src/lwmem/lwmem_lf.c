@@ -0,0 +1,533 @@
+/**
+ * \file            lwmem_lf.c
+ * \brief           Lock-free size-class allocator on top of lightweight dynamic memory manager
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#include "lwmem/lwmem_lf.h"
+#include "stdint.h"
+
+/* --- Memory unique part starts --- */
+/**
+ * \brief           Memory function/typedef prefix string
+ */
+#define LWMEM_PREF(x)                   lwmem_ ## x
+
+/**
+ * \brief           Number of significant bits of object address, used to pack address and version tag in stack head
+ *
+ * It is `48` for user space of common 64-bit systems. Remaining bits hold version tag.
+ * On 32-bit systems, stack head is 64-bit wide and holds complete address
+ */
+#ifndef LWMEM_LF_ADDR_BITS
+#if UINTPTR_MAX > 0xFFFFFFFFUL
+#define LWMEM_LF_ADDR_BITS              48
+#else
+#define LWMEM_LF_ADDR_BITS              32
+#endif /* UINTPTR_MAX > 0xFFFFFFFFUL */
+#endif /* LWMEM_LF_ADDR_BITS */
+
+/**
+ * \brief           Size of cache line, stack heads of size classes are placed in separate lines
+ */
+#ifndef LWMEM_LF_CACHE_LINE
+#define LWMEM_LF_CACHE_LINE             64
+#endif /* LWMEM_LF_CACHE_LINE */
+
+/**
+ * \brief           Atomic operations on stack heads and remote-free queues
+ *
+ * Default implementation uses builtin functions of GCC and Clang compilers.
+ * Define all of them before including source file to use other compiler
+ */
+#ifndef LWMEM_LF_LOAD
+#if !defined(__GNUC__)
+#error "LWMEM_LF_LOAD, LWMEM_LF_STORE, LWMEM_LF_XCHG and LWMEM_LF_CAS must be defined for this compiler"
+#endif /* !defined(__GNUC__) */
+#define LWMEM_LF_LOAD(ptr)              __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define LWMEM_LF_STORE(ptr, val)        __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#define LWMEM_LF_XCHG(ptr, val)         __atomic_exchange_n((ptr), (val), __ATOMIC_ACQ_REL)
+#define LWMEM_LF_CAS(ptr, exp, des)     __atomic_compare_exchange_n((ptr), (exp), (des), 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#endif /* LWMEM_LF_LOAD */
+/* --- Memory unique part ends --- */
+
+/**
+ * \brief           Cast input pointer to byte
+ */
+#define LWMEM_TO_BYTE_PTR(_p_)          ((unsigned char *)(_p_))
+
+/**
+ * \brief           Alignment of objects, low bits of object address are not stored in stack head
+ */
+#define LWMEM_LF_ALIGN_BITS             4
+
+/**
+ * \brief           Number of size classes
+ */
+#define LWMEM_LF_CLASS_COUNT            (sizeof(lf_class_size) / sizeof(lf_class_size[0]))
+
+/**
+ * \brief           Pack object address and version tag to stack head
+ */
+#define LWMEM_LF_PACK(obj, tag)         (((uint64_t)(uintptr_t)(obj) >> LWMEM_LF_ALIGN_BITS) \
+                                            | ((uint64_t)(tag) << (LWMEM_LF_ADDR_BITS - LWMEM_LF_ALIGN_BITS)))
+
+/**
+ * \brief           Get object address from stack head
+ */
+#define LWMEM_LF_OBJ(head)              ((lwmem_lf_obj_t *)(uintptr_t)(((head) \
+                                            & (((uint64_t)1 << (LWMEM_LF_ADDR_BITS - LWMEM_LF_ALIGN_BITS)) - 1)) << LWMEM_LF_ALIGN_BITS))
+
+/**
+ * \brief           Get version tag from stack head
+ */
+#define LWMEM_LF_TAG(head)              ((head) >> (LWMEM_LF_ADDR_BITS - LWMEM_LF_ALIGN_BITS))
+
+/**
+ * \brief           Get chunk of object
+ */
+#define LWMEM_LF_CHUNK(ptr)             ((lwmem_lf_chunk_t *)((uintptr_t)(ptr) & ~((uintptr_t)LWMEM_LF_CHUNK_SIZE - 1)))
+
+/**
+ * \brief           Size of chunk header, objects follow it
+ */
+#define LWMEM_LF_CHUNK_HDR_SIZE         ((sizeof(lwmem_lf_chunk_t) + LWMEM_LF_CACHE_LINE - 1) & ~((size_t)LWMEM_LF_CACHE_LINE - 1))
+
+/**
+ * \brief           Object sizes of size classes, two classes per doubling above `64` bytes
+ */
+static const size_t lf_class_size[] = { 16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, LWMEM_LF_MAX_SIZE };
+
+/**
+ * \brief           Free object, linked to stack of its size class
+ */
+typedef struct lwmem_lf_obj {
+    struct lwmem_lf_obj* next;                  /*!< Next free object */
+} lwmem_lf_obj_t;
+
+/**
+ * \brief           Chunk of objects of single size class, taken from heap
+ */
+typedef struct lwmem_lf_chunk {
+    struct lwmem_lf_chunk* next;                /*!< Previously allocated chunk */
+    LWMEM_PREF(lf_t)* lf;                       /*!< Allocator chunk belongs to */
+    LWMEM_PREF(lf_thread_t)* owner;             /*!< Thread cache owning objects, `NULL` when objects are in shared stacks */
+    size_t cls;                                 /*!< Size class of objects */
+} lwmem_lf_chunk_t;
+
+/**
+ * \brief           Stack of free objects, in its own cache line
+ */
+typedef struct {
+    uint64_t head;                              /*!< Top object and version tag, packed with \ref LWMEM_LF_PACK */
+    unsigned char pad[LWMEM_LF_CACHE_LINE - sizeof(uint64_t)];  /*!< Padding to size of cache line */
+} lwmem_lf_stack_t;
+
+/**
+ * \brief           Lock-free allocator structure
+ */
+struct LWMEM_PREF(lf) {
+    lwmem_lf_stack_t stacks[sizeof(lf_class_size) / sizeof(lf_class_size[0])];  /*!< Stacks of free objects, one per size class */
+    lwmem_lf_chunk_t* chunks;                   /*!< List of allocated chunks */
+    LWMEM_PREF(lf_thread_t)* threads;           /*!< List of thread caches, used or abandoned */
+};
+
+/**
+ * \brief           Thread cache structure
+ *
+ * Remote-free queue is intrusive multi-producer single-consumer queue by Dmitry Vyukov.
+ * Producers push with single atomic exchange, without retry loop,
+ * while owner takes objects from tail of queue
+ */
+struct LWMEM_PREF(lf_thread) {
+    lwmem_lf_obj_t* remote_head;                /*!< Last object pushed by other threads */
+    unsigned char pad[LWMEM_LF_CACHE_LINE - sizeof(lwmem_lf_obj_t*)];  /*!< Padding to keep producers out of owner cache lines */
+    lwmem_lf_obj_t* remote_tail;                /*!< Next object to be reclaimed by owner */
+    lwmem_lf_obj_t remote_stub;                 /*!< Stub object, keeps queue non-empty */
+    lwmem_lf_obj_t* free[sizeof(lf_class_size) / sizeof(lf_class_size[0])];  /*!< Free objects, one list per size class */
+    LWMEM_PREF(lf_t)* lf;                       /*!< Allocator thread cache belongs to */
+    struct LWMEM_PREF(lf_thread)* next;         /*!< Next thread cache of allocator */
+    unsigned char abandoned;                    /*!< Set to `1` when thread cache is not used by any thread */
+};
+
+/**
+ * \brief           Get size class of allocation size
+ * \param[in]       size: Size in units of bytes, from `1` to \ref LWMEM_LF_MAX_SIZE
+ * \return          Size class index
+ */
+static size_t
+prv_lf_class(const size_t size) {
+    size_t bit;
+
+    if (size <= 64) {
+        return (size - 1) >> 4;
+    }
+
+    /* Find highest bit of size and check if size is in lower or upper half of doubling */
+    for (bit = 6; ((size - 1) >> (bit + 1)) != 0; ++bit) {}
+    return 4 + (bit - 6) * 2 + (((size - 1) >> (bit - 1)) & 0x01);
+}
+
+/**
+ * \brief           Push list of linked objects to stack
+ * \param[in]       stack: Stack of size class
+ * \param[in]       first: First object of list
+ * \param[in]       last: Last object of list, it gets linked to current top of stack
+ */
+static void
+prv_lf_push(lwmem_lf_stack_t* const stack, lwmem_lf_obj_t* const first, lwmem_lf_obj_t* const last) {
+    uint64_t head = LWMEM_LF_LOAD(&stack->head);
+
+    do {
+        last->next = LWMEM_LF_OBJ(head);
+    } while (!LWMEM_LF_CAS(&stack->head, &head, LWMEM_LF_PACK(first, LWMEM_LF_TAG(head) + 1)));
+}
+
+/**
+ * \brief           Take new chunk from heap and link its objects together
+ * \param[in]       lf: Allocator handle
+ * \param[in]       owner: Thread cache owning objects, `NULL` for shared stacks
+ * \param[in]       cls: Size class index
+ * \param[out]      last: Output variable to write last object of list to
+ * \return          First object of list on success, `NULL` otherwise
+ */
+static lwmem_lf_obj_t *
+prv_lf_grow(LWMEM_PREF(lf_t)* const lf, LWMEM_PREF(lf_thread_t)* const owner, const size_t cls, lwmem_lf_obj_t** const last) {
+    lwmem_lf_chunk_t* chunk;
+    lwmem_lf_obj_t* obj;
+    size_t count;
+
+    if ((chunk = LWMEM_PREF(malloc_aligned)(LWMEM_LF_CHUNK_SIZE, LWMEM_LF_CHUNK_SIZE)) == NULL) {
+        return NULL;
+    }
+    chunk->lf = lf;
+    chunk->owner = owner;
+    chunk->cls = cls;
+
+    obj = (void *)(LWMEM_TO_BYTE_PTR(chunk) + LWMEM_LF_CHUNK_HDR_SIZE);
+    for (count = (LWMEM_LF_CHUNK_SIZE - LWMEM_LF_CHUNK_HDR_SIZE) / lf_class_size[cls]; count > 1; --count) {
+        obj->next = (void *)(LWMEM_TO_BYTE_PTR(obj) + lf_class_size[cls]);
+        obj = obj->next;
+    }
+    obj->next = NULL;
+    *last = obj;
+
+    /* Chunks are only added until allocator is destroyed, list is not exposed to ABA problem */
+    chunk->next = LWMEM_LF_LOAD(&lf->chunks);
+    while (!LWMEM_LF_CAS(&lf->chunks, &chunk->next, chunk)) {}
+    return (void *)(LWMEM_TO_BYTE_PTR(chunk) + LWMEM_LF_CHUNK_HDR_SIZE);
+}
+
+/**
+ * \brief           Push object to remote-free queue of thread cache
+ *
+ * Function is wait-free, it completes in fixed number of steps regardless of other threads
+ *
+ * \param[in]       th: Thread cache owning object
+ * \param[in]       obj: Object to push
+ */
+static void
+prv_lf_remote_push(LWMEM_PREF(lf_thread_t)* const th, lwmem_lf_obj_t* const obj) {
+    lwmem_lf_obj_t* prev;
+
+    obj->next = NULL;
+    prev = LWMEM_LF_XCHG(&th->remote_head, obj);
+    LWMEM_LF_STORE(&prev->next, obj);           /* Link is visible to owner after this point */
+}
+
+/**
+ * \brief           Take object from remote-free queue of thread cache
+ * \note            Function must be called by owner of thread cache only
+ * \param[in]       th: Thread cache
+ * \return          Object on success, `NULL` when queue is empty or push by other thread is in progress
+ */
+static lwmem_lf_obj_t *
+prv_lf_remote_pop(LWMEM_PREF(lf_thread_t)* const th) {
+    lwmem_lf_obj_t* tail = th->remote_tail, *next = LWMEM_LF_LOAD(&tail->next);
+
+    if (tail == &th->remote_stub) {             /* Skip stub object */
+        if (next == NULL) {
+            return NULL;
+        }
+        th->remote_tail = tail = next;
+        next = LWMEM_LF_LOAD(&tail->next);
+    }
+    if (next != NULL) {
+        th->remote_tail = next;
+        return tail;
+    }
+    if (tail != LWMEM_LF_LOAD(&th->remote_head)) {
+        return NULL;                            /* Other thread pushed object, but did not link it yet */
+    }
+
+    /* Tail is last object, push stub behind it to take it out of queue */
+    prv_lf_remote_push(th, &th->remote_stub);
+    if ((next = LWMEM_LF_LOAD(&tail->next)) != NULL) {
+        th->remote_tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+/**
+ * \brief           Create new lock-free allocator
+ * \return          Allocator handle on success, `NULL` otherwise
+ */
+LWMEM_PREF(lf_t)*
+LWMEM_PREF(lf_create)(void) {
+    LWMEM_PREF(lf_t)* lf;
+    size_t i;
+
+    if ((lf = LWMEM_PREF(malloc_aligned)(LWMEM_LF_CACHE_LINE, sizeof(*lf))) != NULL) {
+        for (i = 0; i < LWMEM_LF_CLASS_COUNT; ++i) {
+            lf->stacks[i].head = 0;
+        }
+        lf->chunks = NULL;
+        lf->threads = NULL;
+    }
+    return lf;
+}
+
+/**
+ * \brief           Destroy allocator and return all its memory to heap
+ * \note            Allocator and its thread caches must not be used by any thread when function is called
+ * \param[in]       lf: Allocator handle. It must not be used after this call
+ */
+void
+LWMEM_PREF(lf_destroy)(LWMEM_PREF(lf_t)* const lf) {
+    LWMEM_PREF(lf_thread_t)* th;
+    lwmem_lf_chunk_t* chunk;
+
+    if (lf == NULL) {
+        return;
+    }
+    while ((th = lf->threads) != NULL) {
+        lf->threads = th->next;
+        LWMEM_PREF(free)(th);
+    }
+    while ((chunk = lf->chunks) != NULL) {
+        lf->chunks = chunk->next;
+        LWMEM_PREF(free)(chunk);
+    }
+    LWMEM_PREF(free)(lf);
+}
+
+/**
+ * \brief           Allocate memory from allocator
+ *
+ * Object is taken from stack of size class with single compare-and-swap operation.
+ * New chunk is taken from heap only when stack is empty
+ *
+ * \param[in]       lf: Allocator handle
+ * \param[in]       size: Number of bytes to allocate, up to \ref LWMEM_LF_MAX_SIZE
+ * \return          Pointer to allocated memory on success, `NULL` otherwise.
+ *                      Larger allocations shall be done from heap directly
+ */
+void *
+LWMEM_PREF(lf_alloc)(LWMEM_PREF(lf_t)* const lf, const size_t size) {
+    lwmem_lf_stack_t* stack;
+    lwmem_lf_obj_t* obj, *last;
+    uint64_t head;
+    size_t cls;
+
+    if (lf == NULL || size == 0 || size > LWMEM_LF_MAX_SIZE) {
+        return NULL;
+    }
+    cls = prv_lf_class(size);
+    stack = &lf->stacks[cls];
+
+    /*
+     * Next pointer of top object may be changed by other thread, which allocated it in the meantime.
+     * Memory stays valid as chunks are never returned to heap,
+     * and version tag makes compare-and-swap fail in such case
+     */
+    head = LWMEM_LF_LOAD(&stack->head);
+    do {
+        if ((obj = LWMEM_LF_OBJ(head)) == NULL) {
+            /* Keep first object of new chunk and push others to stack */
+            if ((obj = prv_lf_grow(lf, NULL, cls, &last)) != NULL && obj->next != NULL) {
+                prv_lf_push(stack, obj->next, last);
+            }
+            return obj;
+        }
+    } while (!LWMEM_LF_CAS(&stack->head, &head, LWMEM_LF_PACK(LWMEM_LF_LOAD(&obj->next), LWMEM_LF_TAG(head) + 1)));
+    return obj;
+}
+
+/**
+ * \brief           Return memory back to allocator it was allocated from
+ *
+ * Function can be called from any thread. Memory of thread cache is pushed to its remote-free queue
+ *
+ * \param[in]       ptr: Memory allocated with \ref lwmem_lf_alloc or \ref lwmem_lf_thread_alloc.
+ *                      `NULL` pointer is valid input
+ */
+void
+LWMEM_PREF(lf_free)(void* const ptr) {
+    lwmem_lf_chunk_t* chunk;
+
+    if (ptr != NULL) {
+        chunk = LWMEM_LF_CHUNK(ptr);
+        if (chunk->owner != NULL) {
+            prv_lf_remote_push(chunk->owner, ptr);
+        } else {
+            prv_lf_push(&chunk->lf->stacks[chunk->cls], ptr, ptr);
+        }
+    }
+}
+
+/**
+ * \brief           Get usable size of memory allocated with \ref lwmem_lf_alloc or \ref lwmem_lf_thread_alloc
+ * \param[in]       ptr: Allocated memory. `NULL` pointer is valid input
+ * \return          Size of size class in units of bytes, `0` for `NULL` pointer
+ */
+size_t
+LWMEM_PREF(lf_usable_size)(void* const ptr) {
+    return ptr != NULL ? lf_class_size[LWMEM_LF_CHUNK(ptr)->cls] : 0;
+}
+
+/**
+ * \brief           Attach thread cache to calling thread
+ *
+ * Thread cache abandoned by exited thread is adopted when available,
+ * together with its free objects. New thread cache is created otherwise
+ *
+ * \param[in]       lf: Allocator handle
+ * \return          Thread cache handle on success, `NULL` otherwise
+ */
+LWMEM_PREF(lf_thread_t)*
+LWMEM_PREF(lf_thread_attach)(LWMEM_PREF(lf_t)* const lf) {
+    LWMEM_PREF(lf_thread_t)* th;
+    unsigned char abandoned;
+    size_t i;
+
+    if (lf == NULL) {
+        return NULL;
+    }
+    for (th = LWMEM_LF_LOAD(&lf->threads); th != NULL; th = th->next) {
+        abandoned = 1;
+        if (LWMEM_LF_LOAD(&th->abandoned) && LWMEM_LF_CAS(&th->abandoned, &abandoned, 0)) {
+            return th;
+        }
+    }
+
+    if ((th = LWMEM_PREF(malloc_aligned)(LWMEM_LF_CACHE_LINE, sizeof(*th))) == NULL) {
+        return NULL;
+    }
+    th->remote_stub.next = NULL;
+    th->remote_head = th->remote_tail = &th->remote_stub;
+    for (i = 0; i < LWMEM_LF_CLASS_COUNT; ++i) {
+        th->free[i] = NULL;
+    }
+    th->lf = lf;
+    th->abandoned = 0;
+
+    /* Thread caches are only added until allocator is destroyed, list is not exposed to ABA problem */
+    th->next = LWMEM_LF_LOAD(&lf->threads);
+    while (!LWMEM_LF_CAS(&lf->threads, &th->next, th)) {}
+    return th;
+}
+
+/**
+ * \brief           Detach thread cache from calling thread
+ *
+ * Function shall be called before thread exits. Thread cache keeps its memory and receives remote frees,
+ * until it is adopted by other thread with \ref lwmem_lf_thread_attach
+ *
+ * \param[in]       th: Thread cache handle. It must not be used by calling thread after this call
+ */
+void
+LWMEM_PREF(lf_thread_detach)(LWMEM_PREF(lf_thread_t)* const th) {
+    if (th != NULL) {
+        LWMEM_LF_STORE(&th->abandoned, 1);
+    }
+}
+
+/**
+ * \brief           Allocate memory from thread cache
+ *
+ * Memory is allocated without atomic operations from free list of thread cache.
+ * When list is empty, objects freed by other threads are reclaimed from remote-free queue in single batch,
+ * and new chunk is taken from heap only when none of them is of requested size class
+ *
+ * \param[in]       th: Thread cache of calling thread
+ * \param[in]       size: Number of bytes to allocate, up to \ref LWMEM_LF_MAX_SIZE
+ * \return          Pointer to allocated memory on success, `NULL` otherwise
+ */
+void *
+LWMEM_PREF(lf_thread_alloc)(LWMEM_PREF(lf_thread_t)* const th, const size_t size) {
+    lwmem_lf_obj_t* obj, *last;
+    size_t cls, c;
+
+    if (th == NULL || size == 0 || size > LWMEM_LF_MAX_SIZE) {
+        return NULL;
+    }
+    cls = prv_lf_class(size);
+    if (th->free[cls] == NULL) {
+        /* Reclaim remote frees to lists of their size classes */
+        while ((obj = prv_lf_remote_pop(th)) != NULL) {
+            c = LWMEM_LF_CHUNK(obj)->cls;
+            obj->next = th->free[c];
+            th->free[c] = obj;
+        }
+        if (th->free[cls] == NULL && (th->free[cls] = prv_lf_grow(th->lf, th, cls, &last)) == NULL) {
+            return NULL;
+        }
+    }
+    obj = th->free[cls];
+    th->free[cls] = obj->next;
+    return obj;
+}
+
+/**
+ * \brief           Return memory to thread cache of calling thread
+ *
+ * Memory owned by thread cache is put to its free list without atomic operations.
+ * Memory of other thread caches and shared stacks is returned with \ref lwmem_lf_free
+ *
+ * \param[in]       th: Thread cache of calling thread
+ * \param[in]       ptr: Memory allocated with \ref lwmem_lf_alloc or \ref lwmem_lf_thread_alloc.
+ *                      `NULL` pointer is valid input
+ */
+void
+LWMEM_PREF(lf_thread_free)(LWMEM_PREF(lf_thread_t)* const th, void* const ptr) {
+    lwmem_lf_chunk_t* chunk;
+    lwmem_lf_obj_t* obj = ptr;
+
+    if (obj == NULL) {
+        return;
+    }
+    chunk = LWMEM_LF_CHUNK(obj);
+    if (th != NULL && chunk->owner == th) {
+        obj->next = th->free[chunk->cls];
+        th->free[chunk->cls] = obj;
+    } else {
+        LWMEM_PREF(lf_free)(obj);
+    }
+}
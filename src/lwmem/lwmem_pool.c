@@ -0,0 +1,345 @@
+/**
+ * \file            lwmem_pool.c
+ * \brief           Fixed-size object pool
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#include "lwmem/lwmem_pool.h"
+#if LWMEM_THREAD_SAFE
+#include "lwmem/lwmem_sys.h"
+#endif /* LWMEM_THREAD_SAFE */
+
+/* --- Memory unique part starts --- */
+/**
+ * \brief           Memory function/typedef prefix string
+ */
+#define LWMEM_PREF(x)                   lwmem_ ## x
+
+/**
+ * \brief           Alignment of pool objects when `0` is passed as alignment
+ */
+#define LWMEM_POOL_ALIGN_DEFAULT        (sizeof(void *) > sizeof(double) ? sizeof(void *) : sizeof(double))
+/* --- Memory unique part ends --- */
+
+/**
+ * \brief           Cast input pointer to byte
+ */
+#define LWMEM_TO_BYTE_PTR(_p_)          ((unsigned char *)(_p_))
+
+#if LWMEM_THREAD_SAFE
+#define LWMEM_POOL_PROTECT(pool)        lwmem_sys_mutex_wait(&(pool)->mutex)
+#define LWMEM_POOL_UNPROTECT(pool)      lwmem_sys_mutex_release(&(pool)->mutex)
+#else
+#define LWMEM_POOL_PROTECT(pool)
+#define LWMEM_POOL_UNPROTECT(pool)
+#endif /* LWMEM_THREAD_SAFE */
+
+/**
+ * \brief           Free object, linked to list of free objects in pool
+ */
+typedef struct lwmem_pool_obj {
+    struct lwmem_pool_obj* next;                /*!< Next free object */
+} lwmem_pool_obj_t;
+
+/**
+ * \brief           Chunk of objects, taken from heap. Objects follow chunk structure
+ */
+typedef struct lwmem_pool_chunk {
+    struct lwmem_pool_chunk* next;              /*!< Previously allocated chunk */
+} lwmem_pool_chunk_t;
+
+/**
+ * \brief           Pool structure
+ */
+struct LWMEM_PREF(pool) {
+    lwmem_pool_obj_t* free_list;                /*!< List of free objects */
+    lwmem_pool_chunk_t* chunks;                 /*!< List of allocated chunks */
+    size_t obj_size;                            /*!< Object size, including alignment */
+    size_t align;                               /*!< Object alignment */
+    size_t chunk_count;                         /*!< Number of objects in each new chunk */
+#if LWMEM_THREAD_SAFE
+    LWMEM_SYS_MUTEX_TYPE mutex;                 /*!< Mutex to protect list of free objects */
+#endif /* LWMEM_THREAD_SAFE */
+};
+
+/**
+ * \brief           Take new chunk of objects from heap and add objects to free list
+ * \note            Pool must be protected when function is called
+ * \param[in]       pool: Pool handle
+ * \return          `1` on success, `0` otherwise
+ */
+static unsigned char
+prv_pool_grow(LWMEM_PREF(pool_t)* const pool) {
+    lwmem_pool_chunk_t* chunk;
+    lwmem_pool_obj_t* obj, *first;
+    unsigned char* data;
+    size_t size, actual, count;
+
+    /* Chunk header, worst case alignment padding and objects */
+    size = sizeof(*chunk) + pool->align - 1;
+    if (pool->chunk_count > ((size_t)-1 - size) / pool->obj_size) {
+        return 0;
+    }
+    size += pool->chunk_count * pool->obj_size;
+    if ((chunk = LWMEM_PREF(malloc_at_least)(size, &actual)) == NULL) {
+        return 0;
+    }
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+
+    /* Align first object and use complete usable size of block */
+    data = LWMEM_TO_BYTE_PTR(chunk + 1);
+    data += (pool->align - ((size_t)data & (pool->align - 1))) & (pool->align - 1);
+    count = (actual - (size_t)(data - LWMEM_TO_BYTE_PTR(chunk))) / pool->obj_size;
+
+    /* Link objects together, last one points to existing free list */
+    first = (void *)data;
+    for (; count > 0; count--, data += pool->obj_size) {
+        obj = (void *)data;
+        obj->next = count > 1 ? (void *)(data + pool->obj_size) : pool->free_list;
+    }
+    pool->free_list = first;
+    return 1;
+}
+
+/**
+ * \brief           Create new pool of fixed-size objects
+ * \param[in]       obj_size: Size of single object in units of bytes
+ * \param[in]       align: Alignment of objects, must be power of `2`.
+ *                      Set to `0` to use default alignment, suitable for pointers and `double` type
+ * \param[in]       initial_count: Number of objects allocated at creation.
+ *                      Pool grows by chunks of the same number of objects when all objects are in use
+ * \return          Pool handle on success, `NULL` otherwise
+ */
+LWMEM_PREF(pool_t)*
+LWMEM_PREF(pool_create)(const size_t obj_size, const size_t align, const size_t initial_count) {
+    LWMEM_PREF(pool_t)* pool;
+    size_t a = align != 0 ? align : LWMEM_POOL_ALIGN_DEFAULT;
+    size_t size;
+
+    if (obj_size == 0 || initial_count == 0 || (a & (a - 1))) { /* Alignment must be power of 2 */
+        return NULL;
+    }
+
+    /* Free list link is placed in each object, it must be aligned for it too */
+    if (a < sizeof(lwmem_pool_obj_t)) {
+        a = sizeof(lwmem_pool_obj_t);
+    }
+
+    /* Object must hold free list link and must keep alignment of next object */
+    size = obj_size < sizeof(lwmem_pool_obj_t) ? sizeof(lwmem_pool_obj_t) : obj_size;
+    if ((size + a - 1) < size) {
+        return NULL;
+    }
+    size = (size + a - 1) & ~(a - 1);
+
+    if ((pool = LWMEM_PREF(malloc)(sizeof(*pool))) == NULL) {
+        return NULL;
+    }
+    pool->free_list = NULL;
+    pool->chunks = NULL;
+    pool->obj_size = size;
+    pool->align = a;
+    pool->chunk_count = initial_count;
+#if LWMEM_THREAD_SAFE
+    if (!lwmem_sys_mutex_create(&pool->mutex)) {
+        LWMEM_PREF(free)(pool);
+        return NULL;
+    }
+#endif /* LWMEM_THREAD_SAFE */
+    if (!prv_pool_grow(pool)) {
+#if LWMEM_THREAD_SAFE
+        lwmem_sys_mutex_delete(&pool->mutex);
+#endif /* LWMEM_THREAD_SAFE */
+        LWMEM_PREF(free)(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+/**
+ * \brief           Destroy pool and return all its memory to heap
+ * \note            All magazines of the pool must not be used after this call
+ * \param[in]       pool: Pool handle. It must not be used after this call
+ */
+void
+LWMEM_PREF(pool_destroy)(LWMEM_PREF(pool_t)* const pool) {
+    lwmem_pool_chunk_t* chunk;
+
+    if (pool == NULL) {
+        return;
+    }
+    while ((chunk = pool->chunks) != NULL) {
+        pool->chunks = chunk->next;
+        LWMEM_PREF(free)(chunk);
+    }
+#if LWMEM_THREAD_SAFE
+    lwmem_sys_mutex_delete(&pool->mutex);
+#endif /* LWMEM_THREAD_SAFE */
+    LWMEM_PREF(free)(pool);
+}
+
+/**
+ * \brief           Allocate object from pool
+ * \param[in]       pool: Pool handle
+ * \return          Pointer to allocated object on success, `NULL` otherwise
+ */
+void *
+LWMEM_PREF(pool_alloc)(LWMEM_PREF(pool_t)* const pool) {
+    lwmem_pool_obj_t* obj = NULL;
+
+    if (pool == NULL) {
+        return NULL;
+    }
+    LWMEM_POOL_PROTECT(pool);
+    if (pool->free_list != NULL || prv_pool_grow(pool)) {
+        obj = pool->free_list;
+        pool->free_list = obj->next;
+    }
+    LWMEM_POOL_UNPROTECT(pool);
+    return obj;
+}
+
+/**
+ * \brief           Return object back to pool
+ * \param[in]       pool: Pool handle
+ * \param[in]       ptr: Object previously allocated from the same pool. `NULL` pointer is valid input
+ */
+void
+LWMEM_PREF(pool_free)(LWMEM_PREF(pool_t)* const pool, void* const ptr) {
+    lwmem_pool_obj_t* const obj = ptr;
+
+    if (pool == NULL || obj == NULL) {
+        return;
+    }
+    LWMEM_POOL_PROTECT(pool);
+    obj->next = pool->free_list;
+    pool->free_list = obj;
+    LWMEM_POOL_UNPROTECT(pool);
+}
+
+/**
+ * \brief           Initialize magazine for pool
+ *
+ * Magazine must be used by single thread only, usually it is thread local variable
+ *
+ * \param[in]       mag: Magazine to initialize
+ * \param[in]       pool: Pool handle
+ */
+void
+LWMEM_PREF(pool_mag_init)(LWMEM_PREF(pool_mag_t)* const mag, LWMEM_PREF(pool_t)* const pool) {
+    if (mag != NULL) {
+        mag->pool = pool;
+        mag->count = 0;
+    }
+}
+
+/**
+ * \brief           Refill empty magazine from pool and allocate object from it
+ *
+ * Magazine is refilled with half of its capacity from pool in single batch.
+ * It is slow path of \ref lwmem_pool_mag_alloc, which shall be used by application instead
+ *
+ * \param[in]       mag: Magazine handle
+ * \return          Pointer to allocated object on success, `NULL` otherwise
+ */
+void *
+LWMEM_PREF(pool_mag_refill)(LWMEM_PREF(pool_mag_t)* const mag) {
+    LWMEM_PREF(pool_t)* pool;
+
+    if (mag == NULL || (pool = mag->pool) == NULL) {
+        return NULL;
+    }
+    if (mag->count == 0) {
+        LWMEM_POOL_PROTECT(pool);
+        while (mag->count < (LWMEM_POOL_MAG_SIZE + 1) / 2
+            && (pool->free_list != NULL || prv_pool_grow(pool))) {
+            mag->objs[mag->count++] = pool->free_list;
+            pool->free_list = pool->free_list->next;
+        }
+        LWMEM_POOL_UNPROTECT(pool);
+        if (mag->count == 0) {
+            return NULL;
+        }
+    }
+    return mag->objs[--mag->count];
+}
+
+/**
+ * \brief           Return half of objects of full magazine to pool and cache object in it
+ *
+ * Objects are returned to pool in single batch.
+ * It is slow path of \ref lwmem_pool_mag_free, which shall be used by application instead
+ *
+ * \param[in]       mag: Magazine handle
+ * \param[in]       ptr: Object previously allocated from the same pool. `NULL` pointer is valid input
+ */
+void
+LWMEM_PREF(pool_mag_drain)(LWMEM_PREF(pool_mag_t)* const mag, void* const ptr) {
+    LWMEM_PREF(pool_t)* pool;
+    lwmem_pool_obj_t* obj;
+
+    if (mag == NULL || (pool = mag->pool) == NULL || ptr == NULL) {
+        return;
+    }
+    if (mag->count == LWMEM_POOL_MAG_SIZE) {
+        LWMEM_POOL_PROTECT(pool);
+        while (mag->count > LWMEM_POOL_MAG_SIZE / 2) {
+            obj = mag->objs[--mag->count];
+            obj->next = pool->free_list;
+            pool->free_list = obj;
+        }
+        LWMEM_POOL_UNPROTECT(pool);
+    }
+    mag->objs[mag->count++] = ptr;
+}
+
+/**
+ * \brief           Return all cached objects of magazine back to pool
+ *
+ * Function shall be called before thread owning magazine exits
+ *
+ * \param[in]       mag: Magazine handle
+ */
+void
+LWMEM_PREF(pool_mag_flush)(LWMEM_PREF(pool_mag_t)* const mag) {
+    LWMEM_PREF(pool_t)* pool;
+    lwmem_pool_obj_t* obj;
+
+    if (mag == NULL || (pool = mag->pool) == NULL || mag->count == 0) {
+        return;
+    }
+    LWMEM_POOL_PROTECT(pool);
+    while (mag->count > 0) {
+        obj = mag->objs[--mag->count];
+        obj->next = pool->free_list;
+        pool->free_list = obj;
+    }
+    LWMEM_POOL_UNPROTECT(pool);
+}
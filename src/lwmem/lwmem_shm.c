@@ -0,0 +1,543 @@
+/**
+ * \file            lwmem_shm.c
+ * \brief           Position independent heap in shared memory segment
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#if !defined(_POSIX_C_SOURCE) && !defined(_GNU_SOURCE)
+#define _POSIX_C_SOURCE 200809L                 /* Required for robust mutexes */
+#endif /* !defined(_POSIX_C_SOURCE) && !defined(_GNU_SOURCE) */
+#include "lwmem/lwmem_shm.h"
+#include "errno.h"
+#include "stdint.h"
+#include "pthread.h"
+
+/* --- Memory unique part starts --- */
+/**
+ * \brief           Memory function/typedef prefix string
+ */
+#define LWMEM_PREF(x)                   lwmem_ ## x
+
+/**
+ * \brief           Alignment of memory address and size in segment, power of `2`
+ */
+#ifndef LWMEM_SHM_ALIGN_NUM
+#define LWMEM_SHM_ALIGN_NUM             ((size_t)16)
+#endif /* LWMEM_SHM_ALIGN_NUM */
+/* --- Memory unique part ends --- */
+
+/**
+ * \brief           Segment identification, `LWMS` in ASCII
+ */
+#define LWMEM_SHM_MAGIC                 ((uint32_t)0x534D574C)
+
+/**
+ * \brief           Version of segment layout, incremented on incompatible changes
+ */
+#define LWMEM_SHM_VERSION               ((uint32_t)2)
+
+#define LWMEM_SHM_ALIGN(x)              (((x) + (LWMEM_SHM_ALIGN_NUM - 1)) & ~(LWMEM_SHM_ALIGN_NUM - 1))
+#define LWMEM_SHM_ALLOC_BIT             ((size_t)1 << (sizeof(size_t) * 8 - 1))
+#define LWMEM_SHM_ALLOC_MARK            ((size_t)0xDEADBEEF)    /*!< Odd value is never offset of aligned block */
+#define LWMEM_SHM_META_SIZE             LWMEM_SHM_ALIGN(sizeof(lwmem_shm_block_t))
+#define LWMEM_SHM_HEADER_SIZE           LWMEM_SHM_ALIGN(sizeof(LWMEM_PREF(shm_t)))
+
+/**
+ * \brief           Cast input pointer to byte
+ */
+#define LWMEM_TO_BYTE_PTR(_p_)          ((unsigned char *)(_p_))
+
+/**
+ * \brief           Get block at offset from segment start
+ */
+#define LWMEM_SHM_BLOCK(shm, off)       ((lwmem_shm_block_t *)(LWMEM_TO_BYTE_PTR(shm) + (off)))
+
+/**
+ * \brief           Get offset of block from segment start
+ */
+#define LWMEM_SHM_OFFSET(shm, block)    ((size_t)(LWMEM_TO_BYTE_PTR(block) - LWMEM_TO_BYTE_PTR(shm)))
+
+/**
+ * \brief           Memory block in segment
+ */
+typedef struct {
+    size_t next;                                /*!< Offset of next free block from segment start, `0` for none.
+                                                        Set to \ref LWMEM_SHM_ALLOC_MARK when block is allocated */
+    size_t size;                                /*!< Size of block. MSB bit is set when block is allocated */
+} lwmem_shm_block_t;
+
+/**
+ * \brief           Segment header with complete heap state
+ */
+struct LWMEM_PREF(shm) {
+    uint32_t magic;                             /*!< Segment identification */
+    uint32_t version;                           /*!< Segment layout version */
+    size_t size;                                /*!< Segment size in units of bytes */
+    pthread_mutex_t mutex;                      /*!< Robust process-shared mutex */
+    lwmem_shm_block_t start_block;              /*!< Beginning of list of free blocks */
+    size_t end_block;                           /*!< Offset of end of segment indication block */
+    size_t available;                           /*!< Bytes available for allocation */
+    size_t root;                                /*!< Offset of application root object, `0` when not set */
+};
+
+/**
+ * \brief           Check list of free blocks of recovered segment
+ * \param[in]       shm: Segment handle
+ * \return          `1` when list is consistent, `0` otherwise
+ */
+static unsigned char
+prv_shm_check_free_list(LWMEM_PREF(shm_t)* const shm) {
+    lwmem_shm_block_t* block;
+    size_t off, available = 0;
+
+    for (off = shm->start_block.next; ; off = block->next) {
+        if (off < LWMEM_SHM_HEADER_SIZE || off > shm->end_block || (off & (LWMEM_SHM_ALIGN_NUM - 1))) {
+            return 0;
+        }
+        block = LWMEM_SHM_BLOCK(shm, off);
+        if (off == shm->end_block) {
+            return block->size == 0 && block->next == 0 && available == shm->available;
+        }
+        if (block->next <= off || (block->size & LWMEM_SHM_ALLOC_BIT) || block->size < LWMEM_SHM_META_SIZE
+            || off + block->size > block->next || (off + block->size == block->next && block->next != shm->end_block)) {
+            return 0;
+        }
+        available += block->size;
+    }
+}
+
+/**
+ * \brief           Check all blocks of segment against list of free blocks
+ * \note            List of free blocks must be checked before with \ref prv_shm_check_free_list
+ * \param[in]       shm: Segment handle
+ * \return          `1` when blocks are consistent, `0` otherwise
+ */
+static unsigned char
+prv_shm_check_blocks(LWMEM_PREF(shm_t)* const shm) {
+    lwmem_shm_block_t* block;
+    size_t off, size, free_off = shm->start_block.next;
+
+    for (off = LWMEM_SHM_HEADER_SIZE; off < shm->end_block; off += size) {
+        block = LWMEM_SHM_BLOCK(shm, off);
+        size = block->size & ~LWMEM_SHM_ALLOC_BIT;
+        if (size < LWMEM_SHM_META_SIZE || size > shm->end_block - off) {
+            return 0;                           /* Block must be within segment */
+        }
+        if (block->size & LWMEM_SHM_ALLOC_BIT) {
+            if (block->next != LWMEM_SHM_ALLOC_MARK) {
+                return 0;                       /* Allocated block must have marker */
+            }
+        } else if (off != free_off) {
+            return 0;                           /* Free block must be next in list of free blocks */
+        } else {
+            free_off = block->next;
+        }
+    }
+    return off == shm->end_block && free_off == shm->end_block;
+}
+
+/**
+ * \brief           Rebuild list of free blocks and available bytes from all blocks of segment
+ *
+ * Used after previous mutex owner died, when list may be left in the middle of modification.
+ * Blocks are walked by their sizes, which are always consistent between steps of allocation and free.
+ * Free blocks are linked again and neighbours are merged. Allocated blocks get their marker back,
+ * memory taken from list by process that died before it was marked allocated is free again
+ *
+ * \param[in]       shm: Segment handle
+ * \return          `1` on success, `0` when blocks are corrupted
+ */
+static unsigned char
+prv_shm_rebuild_free_list(LWMEM_PREF(shm_t)* const shm) {
+    lwmem_shm_block_t* block, *prev = &shm->start_block, *end;
+    size_t off, size, available = 0;
+
+    if (shm->size < LWMEM_SHM_HEADER_SIZE + 2 * LWMEM_SHM_META_SIZE || shm->end_block != shm->size - LWMEM_SHM_META_SIZE) {
+        return 0;
+    }
+
+    /* Check complete walk before list is modified */
+    for (off = LWMEM_SHM_HEADER_SIZE; off < shm->end_block; off += size) {
+        size = LWMEM_SHM_BLOCK(shm, off)->size & ~LWMEM_SHM_ALLOC_BIT;
+        if (size < LWMEM_SHM_META_SIZE || size > shm->end_block - off || (size & (LWMEM_SHM_ALIGN_NUM - 1))) {
+            return 0;
+        }
+    }
+
+    for (off = LWMEM_SHM_HEADER_SIZE; off < shm->end_block; off += size) {
+        block = LWMEM_SHM_BLOCK(shm, off);
+        size = block->size & ~LWMEM_SHM_ALLOC_BIT;
+        if (block->size & LWMEM_SHM_ALLOC_BIT) {
+            block->next = LWMEM_SHM_ALLOC_MARK;
+        } else if (prev != &shm->start_block && LWMEM_SHM_OFFSET(shm, prev) + prev->size == off) {
+            prev->size += size;                 /* Merge with previous free block */
+            available += size;
+        } else {
+            prev->next = off;
+            prev = block;
+            available += size;
+        }
+    }
+    prev->next = shm->end_block;
+    end = LWMEM_SHM_BLOCK(shm, shm->end_block);
+    end->size = 0;
+    end->next = 0;
+    shm->available = available;
+    return 1;
+}
+
+/**
+ * \brief           Lock segment
+ *
+ * When previous owner of mutex died while holding it, list of free blocks is rebuilt from all blocks.
+ * Mutex is made consistent when blocks are valid, otherwise it becomes unusable for all processes
+ *
+ * \param[in]       shm: Segment handle
+ * \return          `1` on success, `0` otherwise
+ */
+static unsigned char
+prv_shm_lock(LWMEM_PREF(shm_t)* const shm) {
+    const int res = pthread_mutex_lock(&shm->mutex);
+
+    if (res == EOWNERDEAD) {
+        if (prv_shm_rebuild_free_list(shm) && pthread_mutex_consistent(&shm->mutex) == 0) {
+            return 1;
+        }
+        pthread_mutex_unlock(&shm->mutex);      /* Mutex becomes not recoverable */
+        return 0;
+    }
+    return res == 0;
+}
+
+/**
+ * \brief           Unlock segment
+ * \param[in]       shm: Segment handle
+ */
+static void
+prv_shm_unlock(LWMEM_PREF(shm_t)* const shm) {
+    pthread_mutex_unlock(&shm->mutex);
+}
+
+/**
+ * \brief           Insert free block to address ordered list of free blocks and merge it with neighbours
+ * \param[in]       shm: Segment handle
+ * \param[in]       nb: New free block
+ */
+static void
+prv_shm_insert_free_block(LWMEM_PREF(shm_t)* const shm, lwmem_shm_block_t* nb) {
+    lwmem_shm_block_t* prev, *next;
+    size_t nb_off = LWMEM_SHM_OFFSET(shm, nb);
+
+    for (prev = &shm->start_block; prev->next != 0 && prev->next < nb_off; prev = LWMEM_SHM_BLOCK(shm, prev->next)) {}
+
+    /* Merge with previous block */
+    if (prev != &shm->start_block && LWMEM_SHM_OFFSET(shm, prev) + prev->size == nb_off) {
+        prev->size += nb->size;
+        nb = prev;
+        nb_off = LWMEM_SHM_OFFSET(shm, nb);
+    }
+
+    /* Merge with next block, but never with end of segment indication */
+    next = LWMEM_SHM_BLOCK(shm, prev->next);
+    if (prev->next != 0 && next->size != 0 && nb_off + nb->size == prev->next) {
+        nb->size += next->size;
+        nb->next = next->next;
+    } else {
+        nb->next = prev->next;
+    }
+    if (prev != nb) {
+        prev->next = nb_off;
+    }
+}
+
+/**
+ * \brief           Get allocated block from application pointer
+ * \param[in]       shm: Segment handle
+ * \param[in]       ptr: Application pointer
+ * \return          Allocated block, `NULL` if pointer is not valid
+ */
+static lwmem_shm_block_t*
+prv_shm_get_alloc_block(LWMEM_PREF(shm_t)* const shm, void* const ptr) {
+    lwmem_shm_block_t* block;
+
+    if (shm == NULL || LWMEM_TO_BYTE_PTR(ptr) < LWMEM_TO_BYTE_PTR(shm) + LWMEM_SHM_HEADER_SIZE + LWMEM_SHM_META_SIZE
+        || LWMEM_TO_BYTE_PTR(ptr) >= LWMEM_TO_BYTE_PTR(shm) + shm->end_block) {
+        return NULL;
+    }
+    block = (void *)(LWMEM_TO_BYTE_PTR(ptr) - LWMEM_SHM_META_SIZE);
+    if ((block->size & LWMEM_SHM_ALLOC_BIT) && block->next == LWMEM_SHM_ALLOC_MARK) {
+        return block;
+    }
+    return NULL;
+}
+
+/**
+ * \brief           Initialize heap in memory segment
+ *
+ * Segment is used in complete, with heap state placed at its start.
+ * Function is called by single process, while others attach to segment with \ref lwmem_shm_attach
+ * after initialization is completed
+ *
+ * \param[in]       mem: Segment start address, mapped as shared memory. It must be aligned to \ref LWMEM_SHM_ALIGN_NUM
+ * \param[in]       size: Segment size in units of bytes
+ * \return          Heap handle on success, `NULL` otherwise
+ */
+LWMEM_PREF(shm_t)*
+LWMEM_PREF(shm_init)(void* const mem, const size_t size) {
+    LWMEM_PREF(shm_t)* const shm = mem;
+    lwmem_shm_block_t* first, *end;
+    pthread_mutexattr_t attr;
+    const size_t seg_size = size & ~(LWMEM_SHM_ALIGN_NUM - 1);
+    unsigned char ok;
+
+    if (shm == NULL || ((size_t)mem & (LWMEM_SHM_ALIGN_NUM - 1))
+        || seg_size < LWMEM_SHM_HEADER_SIZE + 2 * LWMEM_SHM_META_SIZE || (seg_size & LWMEM_SHM_ALLOC_BIT)) {
+        return NULL;
+    }
+
+    /* Mutex is shared between processes and recoverable when its owner dies */
+    if (pthread_mutexattr_init(&attr) != 0) {
+        return NULL;
+    }
+    ok = pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED) == 0
+        && pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST) == 0
+        && pthread_mutex_init(&shm->mutex, &attr) == 0;
+    pthread_mutexattr_destroy(&attr);
+    if (!ok) {
+        return NULL;
+    }
+
+    /* Single free block between header and end of segment indication */
+    shm->size = seg_size;
+    shm->end_block = seg_size - LWMEM_SHM_META_SIZE;
+    end = LWMEM_SHM_BLOCK(shm, shm->end_block);
+    end->next = 0;
+    end->size = 0;
+    first = LWMEM_SHM_BLOCK(shm, LWMEM_SHM_HEADER_SIZE);
+    first->next = shm->end_block;
+    first->size = shm->end_block - LWMEM_SHM_HEADER_SIZE;
+    shm->start_block.next = LWMEM_SHM_HEADER_SIZE;
+    shm->start_block.size = 0;
+    shm->available = first->size;
+    shm->root = 0;
+
+    shm->version = LWMEM_SHM_VERSION;
+    shm->magic = LWMEM_SHM_MAGIC;
+    return shm;
+}
+
+/**
+ * \brief           Attach to heap in memory segment, initialized by other process
+ * \param[in]       mem: Segment start address in calling process
+ * \return          Heap handle on success, `NULL` when segment does not contain initialized heap
+ */
+LWMEM_PREF(shm_t)*
+LWMEM_PREF(shm_attach)(void* const mem) {
+    LWMEM_PREF(shm_t)* const shm = mem;
+
+    if (shm == NULL || ((size_t)mem & (LWMEM_SHM_ALIGN_NUM - 1))
+        || shm->magic != LWMEM_SHM_MAGIC || shm->version != LWMEM_SHM_VERSION) {
+        return NULL;
+    }
+    return shm;
+}
+
+/**
+ * \brief           Recover heap in persistent segment, mapped from file
+ *
+ * Function is used when segment is mapped again, for example after application restart,
+ * to get all allocations back without rebuilding them.
+ * Segment identification, version and all blocks are checked before it is used,
+ * and mutex left by previous process is initialized again.
+ *
+ * \note            Function must be called when no other process uses the segment
+ * \param[in]       mem: Segment start address in calling process
+ * \param[in]       size: Size of mapped memory in units of bytes
+ * \return          Heap handle on success, `NULL` when segment does not contain valid heap
+ */
+LWMEM_PREF(shm_t)*
+LWMEM_PREF(shm_recover)(void* const mem, const size_t size) {
+    LWMEM_PREF(shm_t)* const shm = LWMEM_PREF(shm_attach)(mem);
+    pthread_mutexattr_t attr;
+    unsigned char ok;
+
+    if (shm == NULL || shm->size > size || shm->size < LWMEM_SHM_HEADER_SIZE + 2 * LWMEM_SHM_META_SIZE
+        || shm->end_block != shm->size - LWMEM_SHM_META_SIZE || shm->root >= shm->end_block
+        || !prv_shm_check_free_list(shm) || !prv_shm_check_blocks(shm)) {
+        return NULL;
+    }
+    if (pthread_mutexattr_init(&attr) != 0) {
+        return NULL;
+    }
+    ok = pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED) == 0
+        && pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST) == 0
+        && pthread_mutex_init(&shm->mutex, &attr) == 0;
+    pthread_mutexattr_destroy(&attr);
+    return ok ? shm : NULL;
+}
+
+/**
+ * \brief           Set application root object of segment
+ *
+ * Root object is entry point to application data in segment,
+ * available to attaching processes and after recovery with \ref lwmem_shm_get_root
+ *
+ * \param[in]       shm: Heap handle
+ * \param[in]       ptr: Root object in segment, usually allocated with \ref lwmem_shm_malloc. `NULL` to clear it
+ * \return          `1` on success, `0` otherwise
+ */
+unsigned char
+LWMEM_PREF(shm_set_root)(LWMEM_PREF(shm_t)* const shm, void* const ptr) {
+    const size_t off = LWMEM_PREF(shm_to_offset)(shm, ptr);
+
+    if (shm == NULL || (ptr != NULL && off == 0) || !prv_shm_lock(shm)) {
+        return 0;
+    }
+    shm->root = off;
+    prv_shm_unlock(shm);
+    return 1;
+}
+
+/**
+ * \brief           Get application root object of segment
+ * \param[in]       shm: Heap handle
+ * \return          Root object, `NULL` when it is not set
+ */
+void *
+LWMEM_PREF(shm_get_root)(LWMEM_PREF(shm_t)* const shm) {
+    return shm != NULL ? LWMEM_PREF(shm_from_offset)(shm, shm->root) : NULL;
+}
+
+/**
+ * \brief           Allocate memory in segment
+ * \param[in]       shm: Heap handle
+ * \param[in]       size: Number of bytes to allocate
+ * \return          Pointer to allocated memory on success, `NULL` otherwise
+ */
+void *
+LWMEM_PREF(shm_malloc)(LWMEM_PREF(shm_t)* const shm, const size_t size) {
+    lwmem_shm_block_t* prev, *curr, *nb;
+    const size_t final_size = LWMEM_SHM_ALIGN(size) + LWMEM_SHM_META_SIZE;
+
+    if (shm == NULL || size == 0 || final_size < size || (final_size & LWMEM_SHM_ALLOC_BIT) || !prv_shm_lock(shm)) {
+        return NULL;
+    }
+
+    /* Find first free block big enough */
+    prev = &shm->start_block;
+    curr = LWMEM_SHM_BLOCK(shm, prev->next);
+    while (curr->size < final_size) {
+        if (curr->next == 0) {                  /* End of segment reached */
+            prv_shm_unlock(shm);
+            return NULL;
+        }
+        prev = curr;
+        curr = LWMEM_SHM_BLOCK(shm, curr->next);
+    }
+    prev->next = curr->next;
+    shm->available -= curr->size;
+
+    /* Split too big block */
+    if (curr->size - final_size >= LWMEM_SHM_META_SIZE) {
+        nb = (void *)(LWMEM_TO_BYTE_PTR(curr) + final_size);
+        nb->size = curr->size - final_size;
+        curr->size = final_size;
+        shm->available += nb->size;
+        prv_shm_insert_free_block(shm, nb);
+    }
+    curr->size |= LWMEM_SHM_ALLOC_BIT;
+    curr->next = LWMEM_SHM_ALLOC_MARK;
+    prv_shm_unlock(shm);
+    return LWMEM_TO_BYTE_PTR(curr) + LWMEM_SHM_META_SIZE;
+}
+
+/**
+ * \brief           Free memory in segment, allocated by any attached process
+ * \param[in]       shm: Heap handle
+ * \param[in]       ptr: Memory to free. `NULL` pointer is valid input
+ */
+void
+LWMEM_PREF(shm_free)(LWMEM_PREF(shm_t)* const shm, void* const ptr) {
+    lwmem_shm_block_t* block;
+
+    if (shm == NULL || ptr == NULL || !prv_shm_lock(shm)) {
+        return;
+    }
+    if ((block = prv_shm_get_alloc_block(shm, ptr)) != NULL) {
+        block->size &= ~LWMEM_SHM_ALLOC_BIT;
+        shm->available += block->size;
+        prv_shm_insert_free_block(shm, block);
+    }
+    prv_shm_unlock(shm);
+}
+
+/**
+ * \brief           Get usable size of memory allocated in segment
+ * \param[in]       shm: Heap handle
+ * \param[in]       ptr: Allocated memory
+ * \return          Usable size in units of bytes, `0` if pointer is not valid
+ */
+size_t
+LWMEM_PREF(shm_usable_size)(LWMEM_PREF(shm_t)* const shm, void* const ptr) {
+    const lwmem_shm_block_t* const block = prv_shm_get_alloc_block(shm, ptr);
+
+    return block != NULL ? (block->size & ~LWMEM_SHM_ALLOC_BIT) - LWMEM_SHM_META_SIZE : 0;
+}
+
+/**
+ * \brief           Convert pointer in segment to offset, valid in all attached processes
+ *
+ * Offset is used to pass memory to other process, which converts it back with \ref lwmem_shm_from_offset
+ *
+ * \param[in]       shm: Heap handle
+ * \param[in]       ptr: Pointer in segment
+ * \return          Offset from segment start, `0` when pointer is `NULL` or not in segment
+ */
+size_t
+LWMEM_PREF(shm_to_offset)(LWMEM_PREF(shm_t)* const shm, const void* const ptr) {
+    if (shm == NULL || (const unsigned char *)ptr <= LWMEM_TO_BYTE_PTR(shm)
+        || (const unsigned char *)ptr >= LWMEM_TO_BYTE_PTR(shm) + shm->size) {
+        return 0;
+    }
+    return (size_t)((const unsigned char *)ptr - LWMEM_TO_BYTE_PTR(shm));
+}
+
+/**
+ * \brief           Convert offset in segment to pointer in calling process
+ * \param[in]       shm: Heap handle
+ * \param[in]       offset: Offset from segment start, returned by \ref lwmem_shm_to_offset
+ * \return          Pointer in segment, `NULL` when offset is `0` or not in segment
+ */
+void *
+LWMEM_PREF(shm_from_offset)(LWMEM_PREF(shm_t)* const shm, const size_t offset) {
+    if (shm == NULL || offset == 0 || offset >= shm->size) {
+        return NULL;
+    }
+    return LWMEM_TO_BYTE_PTR(shm) + offset;
+}
@@ -0,0 +1,149 @@
+/**
+ * \file            lwmem_stack.c
+ * \brief           Stack allocator for LIFO temporaries
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#include "lwmem/lwmem_stack.h"
+
+/* --- Memory unique part starts --- */
+/**
+ * \brief           Memory function/typedef prefix string
+ */
+#define LWMEM_PREF(x)                   lwmem_ ## x
+
+/**
+ * \brief           Alignment of stack allocations, suitable for pointers and `double` type
+ */
+#define LWMEM_STACK_ALIGN_NUM           (sizeof(void *) > sizeof(double) ? sizeof(void *) : sizeof(double))
+/* --- Memory unique part ends --- */
+
+/**
+ * \brief           Initialize stack allocator on top of user memory region
+ * \param[in]       stack: Stack structure to initialize
+ * \param[in]       mem: Memory used for stack allocations
+ * \param[in]       size: Size of memory in units of bytes
+ * \return          `1` on success, `0` otherwise
+ */
+unsigned char
+LWMEM_PREF(stack_init)(LWMEM_PREF(stack_t)* const stack, void* const mem, const size_t size) {
+    if (stack == NULL || mem == NULL || size == 0) {
+        return 0;
+    }
+    stack->start = mem;
+    stack->size = size;
+    stack->top = 0;
+    stack->is_heap = 0;
+    return 1;
+}
+
+/**
+ * \brief           Create stack allocator with memory taken from heap
+ * \param[in]       size: Size of stack memory in units of bytes
+ * \return          Stack handle on success, `NULL` otherwise
+ */
+LWMEM_PREF(stack_t)*
+LWMEM_PREF(stack_create)(const size_t size) {
+    LWMEM_PREF(stack_t)* stack;
+    size_t actual;
+
+    if (size == 0 || (sizeof(*stack) + size) < size) {
+        return NULL;
+    }
+
+    /* Stack structure and its memory are in one block */
+    if ((stack = LWMEM_PREF(malloc_at_least)(sizeof(*stack) + size, &actual)) != NULL) {
+        LWMEM_PREF(stack_init)(stack, stack + 1, actual - sizeof(*stack));
+        stack->is_heap = 1;
+    }
+    return stack;
+}
+
+/**
+ * \brief           Destroy stack allocator created with \ref lwmem_stack_create
+ *
+ * All allocations are released. Stack initialized on user memory only gets reset
+ *
+ * \param[in]       stack: Stack handle. Stack created from heap must not be used after this call
+ */
+void
+LWMEM_PREF(stack_destroy)(LWMEM_PREF(stack_t)* const stack) {
+    if (stack != NULL) {
+        stack->top = 0;
+        if (stack->is_heap) {
+            LWMEM_PREF(free)(stack);
+        }
+    }
+}
+
+/**
+ * \brief           Allocate memory on top of the stack
+ * \param[in]       stack: Stack handle
+ * \param[in]       size: Number of bytes to allocate
+ * \return          Pointer to allocated memory on success, `NULL` otherwise
+ */
+void *
+LWMEM_PREF(stack_push)(LWMEM_PREF(stack_t)* const stack, const size_t size) {
+    size_t pad;
+
+    if (stack == NULL || size == 0) {
+        return NULL;
+    }
+
+    /* Align top of the stack to alignment of absolute address */
+    pad = (LWMEM_STACK_ALIGN_NUM - ((size_t)(stack->start + stack->top) & (LWMEM_STACK_ALIGN_NUM - 1))) & (LWMEM_STACK_ALIGN_NUM - 1);
+    if (pad > (stack->size - stack->top) || size > (stack->size - stack->top - pad)) {
+        return NULL;                            /* Not enough memory in the stack */
+    }
+    stack->top += pad + size;
+    return stack->start + stack->top - size;
+}
+
+/**
+ * \brief           Get current top of the stack as mark for later release
+ * \param[in]       stack: Stack handle
+ * \return          Stack mark
+ */
+LWMEM_PREF(stack_mark_t)
+LWMEM_PREF(stack_mark)(const LWMEM_PREF(stack_t)* const stack) {
+    return stack != NULL ? stack->top : 0;
+}
+
+/**
+ * \brief           Release all allocations done after the mark
+ * \param[in]       stack: Stack handle
+ * \param[in]       mark: Stack mark, previously returned by \ref lwmem_stack_mark.
+ *                      Use `0` to release all allocations
+ */
+void
+LWMEM_PREF(stack_release)(LWMEM_PREF(stack_t)* const stack, const LWMEM_PREF(stack_mark_t) mark) {
+    if (stack != NULL && mark <= stack->top) {
+        stack->top = mark;
+    }
+}
@@ -0,0 +1,211 @@
+/**
+ * \file            lwmem_preload.c
+ * \brief           Replacement of standard C allocation functions, for use with `LD_PRELOAD`
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif /* defined(__linux__) && !defined(_GNU_SOURCE) */
+#include "lwmem/lwmem.h"
+#include "errno.h"
+#include "stdint.h"
+#include "stdlib.h"
+#include "pthread.h"
+#include "sys/mman.h"
+#include "unistd.h"
+
+#if !LWMEM_THREAD_SAFE
+#error "Preload library requires LWMEM_THREAD_SAFE to be enabled"
+#endif /* !LWMEM_THREAD_SAFE */
+
+/* --- Memory unique part starts --- */
+/**
+ * \brief           Memory function/typedef prefix string
+ */
+#define LWMEM_PREF(x)                   lwmem_ ## x
+
+/**
+ * \brief           Size of virtual memory reserved for heap on first use
+ *
+ * Memory is reserved without swap space and physical pages are used only when touched.
+ * It can be changed at run-time with `LWMEM_PRELOAD_HEAP_SIZE` environment variable, in units of bytes
+ */
+#define LWMEM_PRELOAD_HEAP_SIZE         (sizeof(void *) >= 8 ? ((size_t)64 << 30) : ((size_t)1 << 30))
+/* --- Memory unique part ends --- */
+
+static pthread_once_t init_once = PTHREAD_ONCE_INIT;
+static unsigned char init_ok;                   /*!< Set to `1` when heap is assigned */
+
+/**
+ * \brief           Lock heap before `fork`, to have it consistent in child process
+ */
+static void
+prv_fork_prepare(void) {
+    LWMEM_PREF(lock)();
+}
+
+/**
+ * \brief           Unlock heap after `fork`, in parent and child process
+ */
+static void
+prv_fork_release(void) {
+    LWMEM_PREF(unlock)();
+}
+
+/**
+ * \brief           Reserve memory from operating system and assign it to heap
+ * \note            Function must not allocate memory with standard library
+ */
+static void
+prv_init(void) {
+    LWMEM_PREF(region_t) region;
+    const char* env;
+    size_t size = LWMEM_PRELOAD_HEAP_SIZE;
+    void* mem;
+
+    if ((env = getenv("LWMEM_PRELOAD_HEAP_SIZE")) != NULL) {
+        size = (size_t)strtoull(env, NULL, 0);
+    }
+    mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mem == MAP_FAILED) {
+        return;
+    }
+    region.start_addr = mem;
+    region.size = size;
+    region.node = 0;
+    if (LWMEM_PREF(assignmem)(&region, 1) == 0) {
+        munmap(mem, size);
+        return;
+    }
+    pthread_atfork(prv_fork_prepare, prv_fork_release, prv_fork_release);
+    init_ok = 1;
+}
+
+/**
+ * \brief           Initialize heap on first use
+ * \return          `1` when heap is ready, `0` otherwise
+ */
+static unsigned char
+prv_ready(void) {
+    pthread_once(&init_once, prv_init);
+    return init_ok;
+}
+
+/**
+ * \brief           Set `errno` to `ENOMEM` when allocation failed
+ * \param[in]       ptr: Allocated memory
+ * \return          Input pointer
+ */
+static void *
+prv_check(void* const ptr) {
+    if (ptr == NULL) {
+        errno = ENOMEM;
+    }
+    return ptr;
+}
+
+void *
+malloc(size_t size) {
+    if (!prv_ready()) {
+        return prv_check(NULL);
+    }
+    return prv_check(LWMEM_PREF(malloc)(size > 0 ? size : 1));  /* Unique pointer for zero size */
+}
+
+void
+free(void* ptr) {
+    if (ptr != NULL) {
+        LWMEM_PREF(free)(ptr);
+    }
+}
+
+void *
+calloc(size_t nitems, size_t size) {
+    if (!prv_ready() || (size > 0 && nitems > SIZE_MAX / size)) {
+        return prv_check(NULL);
+    }
+    if (nitems == 0 || size == 0) {
+        nitems = size = 1;
+    }
+    return prv_check(LWMEM_PREF(calloc)(nitems, size));
+}
+
+void *
+realloc(void* ptr, size_t size) {
+    if (ptr == NULL) {
+        return malloc(size);
+    }
+    if (size == 0) {
+        LWMEM_PREF(free)(ptr);
+        return NULL;
+    }
+    return prv_check(LWMEM_PREF(realloc)(ptr, size));
+}
+
+int
+posix_memalign(void** memptr, size_t alignment, size_t size) {
+    void* ptr;
+
+    if (alignment == 0 || (alignment & (alignment - 1)) || (alignment % sizeof(void *)) != 0) {
+        return EINVAL;
+    }
+    if (!prv_ready() || (ptr = LWMEM_PREF(malloc_aligned)(alignment, size > 0 ? size : 1)) == NULL) {
+        return ENOMEM;
+    }
+    *memptr = ptr;
+    return 0;
+}
+
+void *
+aligned_alloc(size_t alignment, size_t size) {
+    if (alignment == 0 || (alignment & (alignment - 1))) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!prv_ready()) {
+        return prv_check(NULL);
+    }
+    return prv_check(LWMEM_PREF(malloc_aligned)(alignment, size > 0 ? size : 1));
+}
+
+void *
+memalign(size_t alignment, size_t size) {
+    return aligned_alloc(alignment, size);
+}
+
+void *
+valloc(size_t size) {
+    return aligned_alloc((size_t)sysconf(_SC_PAGESIZE), size);
+}
+
+size_t
+malloc_usable_size(void* ptr) {
+    return LWMEM_PREF(usable_size)(ptr);
+}
@@ -0,0 +1,117 @@
+/**
+ * \file            lwmem_preload.cpp
+ * \brief           Replacement of global C++ operator new and delete, for use with `LD_PRELOAD`
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+/*
+ * Operators use standard C functions, replaced in lwmem_preload.c,
+ * which initialize heap on first use, before any memory is taken from it
+ */
+
+/**
+ * \brief           Allocate memory for operator new, calling new handler until success
+ * \param[in]       size: Number of bytes to allocate
+ * \param[in]       alignment: Memory alignment, `0` for default alignment
+ * \return          Pointer to allocated memory on success, `nullptr` when no new handler is installed
+ * \note            Exception thrown by new handler is propagated to caller
+ */
+void*
+prv_new(std::size_t size, std::size_t alignment) {
+    void* ptr;
+
+    if (size == 0) {
+        size = 1;                               /* Unique pointer for zero size */
+    }
+    for (;;) {
+        ptr = alignment > 0 ? std::aligned_alloc(alignment, size) : std::malloc(size);
+        if (ptr != nullptr) {
+            return ptr;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            return nullptr;
+        }
+        handler();                              /* Handler may free memory or throw */
+    }
+}
+
+/**
+ * \brief           Allocate memory for throwing operator new
+ */
+void*
+prv_new_throw(std::size_t size, std::size_t alignment) {
+    void* const ptr = prv_new(size, alignment);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+/**
+ * \brief           Allocate memory for non-throwing operator new
+ */
+void*
+prv_new_nothrow(std::size_t size, std::size_t alignment) noexcept {
+    try {
+        return prv_new(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+} /* namespace */
+
+void* operator new(std::size_t size) { return prv_new_throw(size, 0); }
+void* operator new[](std::size_t size) { return prv_new_throw(size, 0); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return prv_new_nothrow(size, 0); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return prv_new_nothrow(size, 0); }
+void* operator new(std::size_t size, std::align_val_t al) { return prv_new_throw(size, static_cast<std::size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al) { return prv_new_throw(size, static_cast<std::size_t>(al)); }
+void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return prv_new_nothrow(size, static_cast<std::size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return prv_new_nothrow(size, static_cast<std::size_t>(al)); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { std::free(ptr); }
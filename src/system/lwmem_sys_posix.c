@@ -0,0 +1,115 @@
+/**
+ * \file            lwmem_sys_posix.c
+ * \brief           System functions for POSIX threads and Linux NUMA nodes
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE                             /* Required for `getcpu` and `syscall` */
+#endif /* defined(__linux__) && !defined(_GNU_SOURCE) */
+#include "lwmem/lwmem_sys.h"
+#if LWMEM_NUMA && defined(__linux__)
+#include "sched.h"
+#include "unistd.h"
+#include "sys/syscall.h"
+#endif /* LWMEM_NUMA && defined(__linux__) */
+
+#if LWMEM_THREAD_SAFE || __DOXYGEN__
+
+/**
+ * \brief           Create new mutex
+ * \param[out]      m: Output variable to save mutex handle
+ * \return          `1` on success, `0` otherwise
+ */
+unsigned char
+lwmem_sys_mutex_create(LWMEM_SYS_MUTEX_TYPE* m) {
+    return pthread_mutex_init(m, NULL) == 0;
+}
+
+/**
+ * \brief           Wait for a mutex until ready (unlimited time)
+ * \param[in]       m: Mutex handle to wait for
+ * \return          `1` on success, `0` otherwise
+ */
+unsigned char
+lwmem_sys_mutex_wait(LWMEM_SYS_MUTEX_TYPE* m) {
+    return pthread_mutex_lock(m) == 0;
+}
+
+/**
+ * \brief           Release already locked mutex
+ * \param[in]       m: Mutex handle to release
+ * \return          `1` on success, `0` otherwise
+ */
+unsigned char
+lwmem_sys_mutex_release(LWMEM_SYS_MUTEX_TYPE* m) {
+    return pthread_mutex_unlock(m) == 0;
+}
+
+/**
+ * \brief           Delete mutex and release its resources
+ * \param[in]       m: Mutex handle to delete. It must not be locked
+ * \return          `1` on success, `0` otherwise
+ */
+unsigned char
+lwmem_sys_mutex_delete(LWMEM_SYS_MUTEX_TYPE* m) {
+    return pthread_mutex_destroy(m) == 0;
+}
+
+#endif /* LWMEM_THREAD_SAFE || __DOXYGEN__ */
+
+#if LWMEM_NUMA || __DOXYGEN__
+
+/**
+ * \brief           Get NUMA node of CPU running calling thread
+ *
+ * On glibc 2.29 or newer, `getcpu` is served by vDSO without entering kernel.
+ * Raw system call is used on older C libraries
+ *
+ * \return          NUMA node number, `0` when it is not known
+ */
+unsigned int
+lwmem_sys_current_node(void) {
+#if defined(__linux__)
+    unsigned int cpu, node;
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+    if (getcpu(&cpu, &node) == 0) {
+        return node;
+    }
+#elif defined(SYS_getcpu)
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0) {
+        return node;
+    }
+#endif /* defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29)) */
+#endif /* defined(__linux__) */
+    return 0;
+}
+
+#endif /* LWMEM_NUMA || __DOXYGEN__ */
@@ -0,0 +1,67 @@
+/**
+ * \file            test.h
+ * \brief           Common helpers of tests
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#ifndef LWMEM_HDR_TEST_H
+#define LWMEM_HDR_TEST_H
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "lwmem/lwmem.h"
+
+/**
+ * \brief           Fail test when condition is not true, regardless of `NDEBUG`
+ */
+#define TEST_ASSERT(cond)               do {                                            \
+        if (!(cond)) {                                                                  \
+            fprintf(stderr, "%s:%d: assertion failed: %s\n", __FILE__, __LINE__, #cond); \
+            exit(1);                                                                    \
+        }                                                                               \
+    } while (0)
+
+/**
+ * \brief           Check all blocks of heap
+ */
+#define TEST_CHECK_HEAP()               TEST_ASSERT(lwmem_check(LWMEM_CHECK_THOROUGH))
+
+/**
+ * \brief           Get number of bytes available in heap
+ * \return          Available bytes
+ */
+static inline size_t
+test_available(void) {
+    lwmem_stats_t stats;
+
+    lwmem_get_stats(&stats);
+    return stats.mem_available_bytes;
+}
+
+#endif /* LWMEM_HDR_TEST_H */
@@ -0,0 +1,84 @@
+/**
+ * \file            test_arena.c
+ * \brief           Arena allocator with chained chunks and odd alignments
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#include "test.h"
+#include "stdint.h"
+#include "string.h"
+#include "lwmem/lwmem_arena.h"
+
+#define ALLOC_COUNT                     500
+
+static unsigned char mem[1 << 18];
+
+int
+main(void) {
+    const lwmem_region_t regions[] = {{mem, sizeof(mem), 0}};
+    static unsigned char* ptrs[ALLOC_COUNT];
+    lwmem_arena_t* arena;
+    size_t available, align, round, i, k;
+
+    TEST_ASSERT(lwmem_assignmem(regions, 1) == 1);
+    available = test_available();
+    TEST_ASSERT(lwmem_arena_create(0) == NULL);
+    arena = lwmem_arena_create(1000);
+    TEST_ASSERT(arena != NULL);
+
+    /* Arena gets full several times per round and chains new chunks, reset returns them to heap */
+    for (round = 0; round < 3; ++round) {
+        for (i = 0; i < ALLOC_COUNT; ++i) {
+            align = i % 5 == 0 ? 0 : (size_t)1 << (i % 7);
+            ptrs[i] = lwmem_arena_alloc(arena, 1 + i % 37, align);
+            TEST_ASSERT(ptrs[i] != NULL);
+            TEST_ASSERT((uintptr_t)ptrs[i] % (align != 0 ? align : sizeof(double)) == 0);
+            memset(ptrs[i], (int)i, 1 + i % 37);
+        }
+        for (i = 0; i < ALLOC_COUNT; ++i) {
+            for (k = 0; k < 1 + i % 37; ++k) {
+                TEST_ASSERT(ptrs[i][k] == (unsigned char)i);
+            }
+        }
+        ptrs[0] = lwmem_arena_alloc(arena, 5000, 256);  /* Bigger than arena size */
+        TEST_ASSERT(ptrs[0] != NULL && (uintptr_t)ptrs[0] % 256 == 0);
+        memset(ptrs[0], 0xFF, 5000);
+        TEST_CHECK_HEAP();
+        TEST_ASSERT(test_available() < available);
+        lwmem_arena_reset(arena);
+    }
+
+    TEST_ASSERT(lwmem_arena_alloc(arena, 3, 3) == NULL);    /* Alignment must be power of 2 */
+    TEST_ASSERT(lwmem_arena_alloc(arena, 0, 8) == NULL);
+    TEST_ASSERT(lwmem_arena_alloc(arena, sizeof(mem), 8) == NULL);
+    lwmem_arena_destroy(arena);
+    TEST_CHECK_HEAP();
+    TEST_ASSERT(test_available() == available);
+    return 0;
+}
@@ -0,0 +1,206 @@
+/**
+ * \file            test_cpp.cpp
+ * \brief           C++ interface: allocator, unique pointers, memory resources and compile-time configured heap
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include "test.h"
+#include "lwmem/lwmem.hpp"
+
+namespace {
+
+alignas(64) unsigned char mem[1 << 20];
+alignas(64) unsigned char heap_mem1[1 << 16], heap_mem2[1 << 15];
+
+/**
+ * \brief           Over-aligned type
+ */
+struct alignas(128) aligned_obj {
+    int value;
+
+    explicit aligned_obj(int v) : value(v) {}
+};
+
+/**
+ * \brief           Base type, destroyed through pointer to base
+ */
+struct base_obj {
+    virtual ~base_obj() = default;
+};
+
+/**
+ * \brief           Derived type
+ */
+struct derived_obj : base_obj {
+    static int destroyed;
+
+    ~derived_obj() override {
+        ++destroyed;
+    }
+};
+
+int derived_obj::destroyed;
+
+/**
+ * \brief           Check standard containers with allocator and unique pointers
+ */
+void
+test_allocator() {
+    const std::size_t available = test_available();
+    {
+        std::vector<int, lwmem::allocator<int>> vec;
+        std::list<int, lwmem::allocator<int>> list(100, 5);
+        std::map<int, int, std::less<int>, lwmem::allocator<std::pair<const int, int>>> map;
+        std::basic_string<char, std::char_traits<char>, lwmem::allocator<char>> str("string long enough to be allocated on heap");
+
+        for (int i = 0; i < 5000; ++i) {
+            vec.push_back(i);
+            map[i] = -i;
+        }
+        TEST_ASSERT(vec[4999] == 4999 && map[4999] == -4999 && list.back() == 5);
+        TEST_ASSERT(test_available() < available);
+        TEST_ASSERT(lwmem::allocator<int>() == lwmem::allocator<char>());
+
+        int* ptr = lwmem::allocator<int>().allocate(0);  /* Zero objects get unique pointer */
+        TEST_ASSERT(ptr != nullptr);
+        lwmem::allocator<int>().deallocate(ptr, 0);
+
+        auto obj = lwmem::make_unique<aligned_obj>(5);
+        TEST_ASSERT(reinterpret_cast<std::uintptr_t>(obj.get()) % 128 == 0 && obj->value == 5);
+        auto arr = lwmem::make_unique<int[]>(100);
+        TEST_ASSERT(arr[0] == 0 && arr[99] == 0);
+        lwmem::unique_ptr<base_obj> derived = lwmem::make_unique<derived_obj>();
+        TEST_ASSERT(derived != nullptr);
+    }
+    TEST_ASSERT(derived_obj::destroyed == 1);
+    TEST_CHECK_HEAP();
+    TEST_ASSERT(test_available() == available);
+}
+
+/**
+ * \brief           Check polymorphic memory resources on top of heap and arena
+ */
+void
+test_resources() {
+    const std::size_t available = test_available();
+    {
+        lwmem::memory_resource heap_res;
+        lwmem::synchronized_memory_resource sync_res;
+        lwmem::arena_resource arena_res(4096);
+
+        TEST_ASSERT(heap_res.is_equal(sync_res) && *lwmem::heap_resource() == sync_res);
+        TEST_ASSERT(!arena_res.is_equal(heap_res) && !heap_res.is_equal(arena_res) && arena_res.is_equal(arena_res));
+
+        std::pmr::vector<int> vec(lwmem::heap_resource());
+        for (int i = 0; i < 10000; ++i) {
+            vec.push_back(i);
+        }
+        void* ptr = sync_res.allocate(100, 256);
+        TEST_ASSERT(reinterpret_cast<std::uintptr_t>(ptr) % 256 == 0);
+        sync_res.deallocate(ptr, 100, 256);
+
+        std::pmr::map<int, std::pmr::string> map(&arena_res);
+        for (int i = 0; i < 1000; ++i) {
+            map[i] = std::pmr::string("string long enough to be allocated in arena", &arena_res);
+        }
+        TEST_ASSERT(map[999].size() > 20 && vec[9999] == 9999);
+        map.clear();
+        arena_res.release();
+    }
+    TEST_CHECK_HEAP();
+    TEST_ASSERT(test_available() == available);
+}
+
+/**
+ * \brief           Allocate and free random blocks of heap with compile-time configuration
+ * \tparam          Heap: Heap type
+ * \param[in]       seed: Random seed
+ */
+template<typename Heap>
+void
+test_heap(unsigned int seed) {
+    Heap heap;
+    void* ptrs[100] = {};
+    std::size_t sizes[100] = {};
+    unsigned char tags[100] = {};
+
+    TEST_ASSERT(heap.add_region(heap_mem1 + 3, sizeof(heap_mem1) - 3));
+    TEST_ASSERT(heap.add_region(heap_mem2, sizeof(heap_mem2) - 5) == (+heap_mem2 > +heap_mem1));
+    const std::size_t available = heap.available();
+
+    std::srand(seed);
+    for (int it = 0; it < 20000; ++it) {
+        const int i = std::rand() % 100;
+
+        if (ptrs[i] != nullptr) {
+            for (std::size_t k = 0; k < sizes[i]; ++k) {
+                TEST_ASSERT(static_cast<unsigned char*>(ptrs[i])[k] == tags[i]);
+            }
+            heap.deallocate(ptrs[i]);
+            ptrs[i] = nullptr;
+        } else {
+            sizes[i] = static_cast<std::size_t>(std::rand() % 700 + 1);
+            if ((ptrs[i] = heap.allocate(sizes[i])) != nullptr) {
+                TEST_ASSERT(reinterpret_cast<std::uintptr_t>(ptrs[i]) % Heap::alignment == 0);
+                TEST_ASSERT(heap.usable_size(ptrs[i]) >= sizes[i]);
+                tags[i] = static_cast<unsigned char>(std::rand());
+                std::memset(ptrs[i], tags[i], sizes[i]);
+            }
+        }
+    }
+    for (void* ptr : ptrs) {
+        heap.deallocate(ptr);
+    }
+    TEST_ASSERT(heap.available() == available);
+}
+
+} /* namespace */
+
+int
+main() {
+    const lwmem_region_t regions[] = {{mem, sizeof(mem), 0}};
+
+    TEST_ASSERT(lwmem_assignmem(regions, 1) == 1);
+    test_allocator();
+    test_resources();
+
+    static_assert(lwmem::heap<8, lwmem::first_fit, lwmem::offset_header>::meta_size == 8);
+    test_heap<lwmem::heap<>>(1);
+    test_heap<lwmem::heap<8, lwmem::best_fit>>(2);
+    test_heap<lwmem::heap<8, lwmem::class_fit, lwmem::offset_header, std::mutex>>(3);
+    test_heap<lwmem::heap<64, lwmem::best_fit, lwmem::offset_header>>(4);
+    return 0;
+}
@@ -0,0 +1,105 @@
+/**
+ * \file            test_histogram.c
+ * \brief           Allocation size histogram and its dump
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#include "test.h"
+#include "string.h"
+
+#define PTR_COUNT                       100
+#define BUCKET_COUNT                    300
+
+static unsigned char mem[1 << 20];
+static char text[1 << 14];
+
+int
+main(void) {
+    const lwmem_region_t regions[] = {{mem, sizeof(mem), 0}};
+    static lwmem_hist_bucket_t buckets[BUCKET_COUNT];
+    void* ptrs[PTR_COUNT];
+    size_t count, requests = 0, live = 0, allocated = 0, freed = 0, len, i;
+    char small[20];
+
+    TEST_ASSERT(lwmem_assignmem(regions, 1) == 1);
+    TEST_ASSERT(lwmem_histogram(NULL, 0) == 0);
+
+    for (i = 0; i < PTR_COUNT; ++i) {
+        ptrs[i] = lwmem_malloc(1 + i * 37);
+        TEST_ASSERT(ptrs[i] != NULL);
+    }
+    for (i = 0; i < PTR_COUNT; i += 2) {
+        lwmem_free(ptrs[i]);
+    }
+    ptrs[1] = lwmem_realloc(ptrs[1], 5000);     /* Free of old block and allocation of new one */
+    TEST_ASSERT(ptrs[1] != NULL);
+    ptrs[0] = lwmem_calloc(10, 10);
+    TEST_ASSERT(ptrs[0] != NULL);
+
+    /* Buckets are sorted by size and counters are consistent */
+    count = lwmem_histogram(buckets, BUCKET_COUNT);
+    TEST_ASSERT(count > 0 && count <= BUCKET_COUNT);
+    TEST_ASSERT(lwmem_histogram(NULL, 0) == count);
+    for (i = 0; i < count; ++i) {
+        TEST_ASSERT(i == 0 || buckets[i].size > buckets[i - 1].size);
+        TEST_ASSERT(buckets[i].live == buckets[i].allocated - buckets[i].freed);
+        requests += buckets[i].requests;
+        allocated += buckets[i].allocated;
+        freed += buckets[i].freed;
+        live += buckets[i].live;
+    }
+    TEST_ASSERT(requests == PTR_COUNT + 2);
+    TEST_ASSERT(allocated == PTR_COUNT + 2 && freed == PTR_COUNT / 2 + 1);
+    TEST_ASSERT(live == PTR_COUNT / 2 + 1);
+    TEST_ASSERT(buckets[count - 1].size >= 5000);
+
+    /* Dump length does not depend on buffer, which is always terminated */
+    for (i = 0; i < 2; ++i) {
+        const lwmem_dump_format_t format = i == 0 ? LWMEM_DUMP_TEXT : LWMEM_DUMP_JSON;
+
+        len = lwmem_histogram_dump(NULL, 0, format);
+        TEST_ASSERT(len > 0 && len < sizeof(text));
+        TEST_ASSERT(lwmem_histogram_dump(text, sizeof(text), format) == len);
+        TEST_ASSERT(strlen(text) == len);
+        TEST_ASSERT(lwmem_histogram_dump(small, sizeof(small), format) == len);
+        TEST_ASSERT(strlen(small) == sizeof(small) - 1 && strncmp(small, text, sizeof(small) - 1) == 0);
+    }
+    TEST_ASSERT(text[0] == '{' && strstr(text, "\"buckets\"") != NULL);
+
+    lwmem_free(ptrs[0]);
+    for (i = 1; i < PTR_COUNT; i += 2) {
+        lwmem_free(ptrs[i]);
+    }
+    count = lwmem_histogram(buckets, BUCKET_COUNT);
+    for (i = 0; i < count; ++i) {
+        TEST_ASSERT(buckets[i].live == 0);
+    }
+    TEST_CHECK_HEAP();
+    return 0;
+}
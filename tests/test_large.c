@@ -0,0 +1,105 @@
+/**
+ * \file            test_large.c
+ * \brief           Large allocations in own memory mappings, reallocated with mremap
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#include "test.h"
+#include "stdint.h"
+#include "string.h"
+
+#define LARGE_SIZE                      ((size_t)3 << 20)
+
+static unsigned char mem[1 << 16];
+
+/**
+ * \brief           Count blocks reported by walk
+ * \param[in]       info: Block information
+ * \param[in]       arg: Number of blocks
+ * \return          `1` to continue walk
+ */
+static unsigned char
+test_count(const lwmem_block_info_t* info, void* arg) {
+    (void)info;
+    ++*(size_t*)arg;
+    return 1;
+}
+
+int
+main(void) {
+    const lwmem_region_t regions[] = {{mem, sizeof(mem), 0}};
+    unsigned char* ptr;
+    size_t available, blocks = 0, i;
+
+    TEST_ASSERT(lwmem_assignmem(regions, 1) == 1);
+    available = test_available();
+
+    /* Large block is bigger than region and does not use it */
+    ptr = lwmem_malloc(LARGE_SIZE);
+    TEST_ASSERT(ptr != NULL && (uintptr_t)ptr % sizeof(void*) == 0);
+    TEST_ASSERT(test_available() == available);
+    TEST_ASSERT(lwmem_usable_size(ptr) >= LARGE_SIZE);
+    TEST_ASSERT(lwmem_walk(test_count, &blocks) == 1 && blocks == 1);
+    memset(ptr, 0x5A, LARGE_SIZE);
+    TEST_CHECK_HEAP();
+
+    /* Reallocation resizes mapping and keeps content, block stays in its own mapping */
+    ptr = lwmem_realloc(ptr, 16 * LARGE_SIZE);
+    TEST_ASSERT(ptr != NULL && lwmem_usable_size(ptr) >= 16 * LARGE_SIZE);
+    ptr[16 * LARGE_SIZE - 1] = 1;
+    for (i = 0; i < LARGE_SIZE; ++i) {
+        TEST_ASSERT(ptr[i] == 0x5A);
+    }
+    ptr = lwmem_realloc(ptr, 100);
+    TEST_ASSERT(ptr != NULL && ptr[0] == 0x5A && ptr[99] == 0x5A);
+    TEST_ASSERT(test_available() == available);
+    lwmem_free(ptr);
+    TEST_ASSERT(test_available() == available);
+
+    /* Small block reallocated to large size leaves region */
+    ptr = lwmem_malloc(1000);
+    TEST_ASSERT(ptr != NULL);
+    memset(ptr, 7, 1000);
+    ptr = lwmem_realloc(ptr, 2 * LARGE_SIZE);
+    TEST_ASSERT(ptr != NULL && ptr[999] == 7);
+    TEST_ASSERT(test_available() == available);
+    TEST_ASSERT(!lwmem_expand_in_place(ptr, 4 * LARGE_SIZE) || lwmem_usable_size(ptr) >= 4 * LARGE_SIZE);
+    lwmem_free(ptr);
+
+    /* Calloc of large block */
+    ptr = lwmem_calloc(1, LARGE_SIZE);
+    TEST_ASSERT(ptr != NULL);
+    for (i = 0; i < LARGE_SIZE; i += 4096) {
+        TEST_ASSERT(ptr[i] == 0);
+    }
+    lwmem_free(ptr);
+    TEST_CHECK_HEAP();
+    TEST_ASSERT(test_available() == available);
+    return 0;
+}
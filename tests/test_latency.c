@@ -0,0 +1,114 @@
+/**
+ * \file            test_latency.c
+ * \brief           Latency histograms of allocator operations
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#include "test.h"
+#include "pthread.h"
+#include "string.h"
+
+#define THREAD_COUNT                    20      /* More threads than histogram slots */
+#define ITER_COUNT                      5000
+
+static unsigned char mem[1 << 22];
+static char text[1 << 13];
+
+/**
+ * \brief           Allocate and free memory
+ * \param[in]       arg: Unused
+ * \return          `NULL`
+ */
+static void*
+test_thread(void* arg) {
+    size_t i;
+
+    (void)arg;
+    for (i = 0; i < ITER_COUNT; ++i) {
+        void* const ptr = lwmem_malloc(32 + i % 64);
+
+        TEST_ASSERT(ptr != NULL);
+        lwmem_free(ptr);
+    }
+    return NULL;
+}
+
+int
+main(void) {
+    const lwmem_region_t regions[] = {{mem, sizeof(mem), 0}};
+    static void* ptrs[2000];
+    pthread_t threads[THREAD_COUNT];
+    lwmem_latency_t lat;
+    size_t len, i;
+
+    TEST_ASSERT(lwmem_assignmem(regions, 1) == 1);
+
+    /* Measurements of all threads are summed */
+    for (i = 0; i < THREAD_COUNT; ++i) {
+        TEST_ASSERT(pthread_create(&threads[i], NULL, test_thread, NULL) == 0);
+    }
+    for (i = 0; i < THREAD_COUNT; ++i) {
+        TEST_ASSERT(pthread_join(threads[i], NULL) == 0);
+    }
+    lwmem_latency(LWMEM_OP_MALLOC, &lat);
+    TEST_ASSERT(lat.count == THREAD_COUNT * ITER_COUNT);
+    TEST_ASSERT(lat.p50 <= lat.p90 && lat.p90 <= lat.p99 && lat.p99 <= lat.p999 && lat.p999 <= lat.max);
+    TEST_ASSERT(lat.mean <= lat.max);
+    lwmem_latency(LWMEM_OP_FREE, &lat);
+    TEST_ASSERT(lat.count == THREAD_COUNT * ITER_COUNT);
+    lwmem_latency(LWMEM_OP_SEARCH, &lat);
+    TEST_ASSERT(lat.count == THREAD_COUNT * ITER_COUNT);
+
+    /* Long free list gets longer searches */
+    lwmem_latency_reset();
+    lwmem_latency(LWMEM_OP_MALLOC, &lat);
+    TEST_ASSERT(lat.count == 0);
+    for (i = 0; i < 2000; ++i) {
+        ptrs[i] = lwmem_malloc(16 + (i % 50) * 16);
+        TEST_ASSERT(ptrs[i] != NULL);
+    }
+    for (i = 0; i < 2000; i += 2) {
+        lwmem_free(ptrs[i]);
+    }
+    TEST_ASSERT(lwmem_malloc(100000) != NULL);  /* Visits all free blocks */
+    lwmem_latency(LWMEM_OP_SEARCH, &lat);
+    TEST_ASSERT(lat.count == 2001 && lat.max >= 1000);
+    lwmem_latency(LWMEM_OP_CALLOC, &lat);
+    TEST_ASSERT(lat.count == 0);
+
+    /* Dump of operations with measurements */
+    len = lwmem_latency_dump(NULL, 0, LWMEM_DUMP_TEXT);
+    TEST_ASSERT(len > 0 && len < sizeof(text));
+    TEST_ASSERT(lwmem_latency_dump(text, sizeof(text), LWMEM_DUMP_TEXT) == len && strlen(text) == len);
+    len = lwmem_latency_dump(NULL, 0, LWMEM_DUMP_JSON);
+    TEST_ASSERT(lwmem_latency_dump(text, sizeof(text), LWMEM_DUMP_JSON) == len && strlen(text) == len);
+    TEST_ASSERT(text[0] == '{' && strstr(text, "malloc") != NULL && strstr(text, "calloc") == NULL);
+    TEST_CHECK_HEAP();
+    return 0;
+}
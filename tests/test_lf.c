@@ -0,0 +1,155 @@
+/**
+ * \file            test_lf.c
+ * \brief           Lock-free allocator and thread caches used from multiple threads
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#include "test.h"
+#include "pthread.h"
+#include "sched.h"
+#include "stdint.h"
+#include "string.h"
+#include "lwmem/lwmem_lf.h"
+
+#define PAIR_COUNT                      4
+#define ITER_COUNT                      20000
+#define RING_SIZE                       256
+
+static unsigned char mem[16 << 20];
+static lwmem_lf_t* lf;
+static void* rings[PAIR_COUNT][RING_SIZE];
+
+/**
+ * \brief           Get allocation size of iteration
+ * \param[in]       id: Thread pair index
+ * \param[in]       it: Iteration
+ * \return          Size in range from `1` to \ref LWMEM_LF_MAX_SIZE
+ */
+static size_t
+test_size(const size_t id, const size_t it) {
+    return 1 + (it * 37 + id * 101) % LWMEM_LF_MAX_SIZE;
+}
+
+/**
+ * \brief           Allocate memory and pass it to consumer, mixing thread cache and shared stacks
+ * \param[in]       arg: Thread pair index
+ * \return          `NULL`
+ */
+static void*
+producer(void* arg) {
+    const size_t id = (size_t)(uintptr_t)arg;
+    lwmem_lf_thread_t* const th = lwmem_lf_thread_attach(lf);
+    size_t it;
+
+    TEST_ASSERT(th != NULL);
+    for (it = 0; it < ITER_COUNT; ++it) {
+        const size_t size = test_size(id, it);
+        unsigned char* const ptr = (it % 3) ? lwmem_lf_thread_alloc(th, size) : lwmem_lf_alloc(lf, size);
+        void** const slot = &rings[id][it % RING_SIZE];
+
+        TEST_ASSERT(ptr != NULL && lwmem_lf_usable_size(ptr) >= size);
+        memset(ptr, (int)id, size);
+        while (__atomic_load_n(slot, __ATOMIC_ACQUIRE) != NULL) {
+            sched_yield();
+        }
+        __atomic_store_n(slot, ptr, __ATOMIC_RELEASE);
+
+        if (it % 7 == 0) {                      /* Local allocation and free */
+            void* const tmp = lwmem_lf_thread_alloc(th, 40);
+            TEST_ASSERT(tmp != NULL);
+            lwmem_lf_thread_free(th, tmp);
+        }
+    }
+    lwmem_lf_thread_detach(th);                 /* Memory still used by consumer */
+    return NULL;
+}
+
+/**
+ * \brief           Check and free memory allocated by producer
+ * \param[in]       arg: Thread pair index
+ * \return          `NULL`
+ */
+static void*
+consumer(void* arg) {
+    const size_t id = (size_t)(uintptr_t)arg;
+    size_t it, k;
+
+    for (it = 0; it < ITER_COUNT; ++it) {
+        void** const slot = &rings[id][it % RING_SIZE];
+        unsigned char* ptr;
+
+        while ((ptr = __atomic_load_n(slot, __ATOMIC_ACQUIRE)) == NULL) {
+            sched_yield();
+        }
+        __atomic_store_n(slot, NULL, __ATOMIC_RELEASE);
+        for (k = 0; k < test_size(id, it); ++k) {
+            TEST_ASSERT(ptr[k] == (unsigned char)id);
+        }
+        lwmem_lf_free(ptr);                     /* Remote free to owner of thread cache */
+    }
+    return NULL;
+}
+
+int
+main(void) {
+    const lwmem_region_t regions[] = {{mem, sizeof(mem), 0}};
+    pthread_t threads[2 * PAIR_COUNT];
+    lwmem_lf_thread_t* th[PAIR_COUNT];
+    size_t available, i;
+
+    TEST_ASSERT(lwmem_assignmem(regions, 1) == 1);
+    available = test_available();
+    lf = lwmem_lf_create();
+    TEST_ASSERT(lf != NULL);
+
+    for (i = 0; i < PAIR_COUNT; ++i) {
+        TEST_ASSERT(pthread_create(&threads[2 * i], NULL, producer, (void*)(uintptr_t)i) == 0);
+        TEST_ASSERT(pthread_create(&threads[2 * i + 1], NULL, consumer, (void*)(uintptr_t)i) == 0);
+    }
+    for (i = 0; i < 2 * PAIR_COUNT; ++i) {
+        TEST_ASSERT(pthread_join(threads[i], NULL) == 0);
+    }
+    TEST_CHECK_HEAP();
+
+    /* Caches of exited threads are adopted by new threads */
+    for (i = 0; i < PAIR_COUNT; ++i) {
+        th[i] = lwmem_lf_thread_attach(lf);
+        TEST_ASSERT(th[i] != NULL);
+        lwmem_lf_thread_free(th[i], lwmem_lf_thread_alloc(th[i], 64));
+    }
+    for (i = 0; i < PAIR_COUNT; ++i) {
+        lwmem_lf_thread_detach(th[i]);
+    }
+    TEST_CHECK_HEAP();
+
+    lwmem_lf_destroy(lf);
+    TEST_CHECK_HEAP();
+    TEST_ASSERT(test_available() == available);
+    return 0;
+}
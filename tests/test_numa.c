@@ -0,0 +1,115 @@
+/**
+ * \file            test_numa.c
+ * \brief           Node-local allocation with regions on two NUMA nodes
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#include "test.h"
+#include "string.h"
+#include "lwmem/lwmem_sys.h"
+
+#define PTR_COUNT                       100
+
+static unsigned char mem1[1 << 14], mem2[1 << 14];
+
+/**
+ * \brief           Get node of region allocated memory belongs to
+ * \param[in]       regions: Regions on node `0` and node `1`
+ * \param[in]       ptr: Allocated memory
+ * \return          Node of region
+ */
+static unsigned int
+test_node(const lwmem_region_t* const regions, const void* const ptr) {
+    const unsigned char* const p = ptr;
+    unsigned int i;
+
+    for (i = 0; i < 2; ++i) {
+        if (p >= (unsigned char*)regions[i].start_addr && p < (unsigned char*)regions[i].start_addr + regions[i].size) {
+            return regions[i].node;
+        }
+    }
+    TEST_ASSERT(0);
+    return 0;
+}
+
+int
+main(void) {
+    lwmem_region_t regions[] = {{mem1, sizeof(mem1), 0}, {mem2, sizeof(mem2), 1}};
+    void* ptrs[PTR_COUNT];
+    size_t available, i, count;
+    unsigned int node;
+    void* ptr;
+
+    /* Regions must be sorted by address, nodes stay in any order */
+    if ((void*)mem2 < (void*)mem1) {
+        regions[0].start_addr = mem2;
+        regions[1].start_addr = mem1;
+    }
+    TEST_ASSERT(lwmem_assignmem(regions, 2) == 2);
+    available = test_available();
+
+    /* Allocation on requested node */
+    ptr = lwmem_malloc_node(100, 1);
+    TEST_ASSERT(ptr != NULL && test_node(regions, ptr) == 1);
+    lwmem_free(ptr);
+    ptr = lwmem_malloc_node(100, 0);
+    TEST_ASSERT(ptr != NULL && test_node(regions, ptr) == 0);
+    lwmem_free(ptr);
+    ptr = lwmem_malloc_node(100, 5);            /* Node without regions */
+    TEST_ASSERT(ptr != NULL);
+    lwmem_free(ptr);
+
+    /* Default allocation is on node of calling thread, when there are regions on it */
+    node = lwmem_sys_current_node();
+    ptr = lwmem_malloc(100);
+    TEST_ASSERT(ptr != NULL);
+    TEST_ASSERT(node > 1 || test_node(regions, ptr) == node);
+    lwmem_free(ptr);
+
+    /* Full node falls back to regions of other node */
+    for (count = 0; count < PTR_COUNT; ++count) {
+        ptrs[count] = lwmem_malloc_node(1000, 1);
+        if (ptrs[count] == NULL) {
+            break;
+        }
+        memset(ptrs[count], 0x5A, 1000);
+    }
+    TEST_ASSERT(count > 0 && test_node(regions, ptrs[0]) == 1);
+    TEST_ASSERT(count < PTR_COUNT && test_node(regions, ptrs[count - 1]) == 0);
+    for (i = 1; i < count; ++i) {
+        TEST_ASSERT(test_node(regions, ptrs[i - 1]) >= test_node(regions, ptrs[i]));  /* Node 1 is used first */
+    }
+    TEST_CHECK_HEAP();
+    for (i = 0; i < count; ++i) {
+        lwmem_free(ptrs[i]);
+    }
+    TEST_CHECK_HEAP();
+    TEST_ASSERT(test_available() == available);
+    return 0;
+}
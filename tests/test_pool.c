@@ -0,0 +1,102 @@
+/**
+ * \file            test_pool.c
+ * \brief           Object pool with odd object sizes and alignments
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#include "test.h"
+#include "stdint.h"
+#include "string.h"
+#include "lwmem/lwmem_pool.h"
+
+#define OBJ_COUNT                       100
+
+static unsigned char mem[1 << 18];
+
+/**
+ * \brief           Allocate objects of pool, check their alignment and that they do not overlap
+ * \param[in]       size: Object size
+ * \param[in]       align: Object alignment
+ */
+static void
+test_pool(const size_t size, const size_t align) {
+    static unsigned char* objs[OBJ_COUNT];
+    const size_t available = test_available();
+    lwmem_pool_t* pool;
+    size_t i, k;
+
+    pool = lwmem_pool_create(size, align, 5);   /* Pool must grow several times */
+    TEST_ASSERT(pool != NULL);
+    for (i = 0; i < OBJ_COUNT; ++i) {
+        objs[i] = lwmem_pool_alloc(pool);
+        TEST_ASSERT(objs[i] != NULL);
+        TEST_ASSERT((uintptr_t)objs[i] % align == 0);
+        TEST_ASSERT((uintptr_t)objs[i] % sizeof(void*) == 0);
+        memset(objs[i], (int)i, size);
+    }
+    TEST_CHECK_HEAP();
+
+    /* Free every second object and allocate it again, free list link must not damage other objects */
+    for (i = 0; i < OBJ_COUNT; i += 2) {
+        lwmem_pool_free(pool, objs[i]);
+    }
+    for (i = 0; i < OBJ_COUNT; i += 2) {
+        objs[i] = lwmem_pool_alloc(pool);
+        TEST_ASSERT(objs[i] != NULL);
+        memset(objs[i], (int)i, size);
+    }
+    for (i = 0; i < OBJ_COUNT; ++i) {
+        for (k = 0; k < size; ++k) {
+            TEST_ASSERT(objs[i][k] == (unsigned char)i);
+        }
+    }
+    TEST_CHECK_HEAP();
+
+    for (i = 0; i < OBJ_COUNT; ++i) {
+        lwmem_pool_free(pool, objs[i]);
+    }
+    lwmem_pool_destroy(pool);
+    TEST_CHECK_HEAP();
+    TEST_ASSERT(test_available() == available);
+}
+
+int
+main(void) {
+    const lwmem_region_t regions[] = {{mem, sizeof(mem), 0}};
+
+    TEST_ASSERT(lwmem_assignmem(regions, 1) == 1);
+    test_pool(9, 2);
+    test_pool(1, 1);
+    test_pool(3, 4);
+    test_pool(13, 8);
+    test_pool(24, 32);
+    test_pool(100, 64);
+    test_pool(17, 128);
+    return 0;
+}
@@ -0,0 +1,142 @@
+/**
+ * \file            test_preload.c
+ * \brief           Program using standard allocation functions, run with preload library
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif /* _GNU_SOURCE */
+#include "test.h"
+#include "dlfcn.h"
+#include "malloc.h"
+#include "pthread.h"
+#include "stdint.h"
+#include "string.h"
+#include "sys/wait.h"
+#include "unistd.h"
+
+#define THREAD_COUNT                    4
+#define ITER_COUNT                      10000
+
+/**
+ * \brief           Memory manager functions of preload library
+ */
+static void (*heap_get_stats)(lwmem_stats_t* stats);
+static size_t (*heap_usable_size)(void* ptr);
+
+/**
+ * \brief           Get number of bytes available in heap of preload library
+ * \return          Available bytes
+ */
+static size_t
+heap_available(void) {
+    lwmem_stats_t stats;
+
+    heap_get_stats(&stats);
+    return stats.mem_available_bytes;
+}
+
+/**
+ * \brief           Allocate and free memory with standard functions
+ * \param[in]       arg: Unused
+ * \return          `NULL`
+ */
+static void*
+test_thread(void* arg) {
+    size_t i;
+
+    (void)arg;
+    for (i = 0; i < ITER_COUNT; ++i) {
+        char* const ptr = malloc(1 + i % 500);
+
+        TEST_ASSERT(ptr != NULL);
+        ptr[i % 500] = (char)i;
+        free(ptr);
+    }
+    return NULL;
+}
+
+int
+main(void) {
+    pthread_t threads[THREAD_COUNT];
+    unsigned char* ptr;
+    size_t available, i;
+    void* aligned;
+    int status;
+    pid_t pid;
+
+    /* Functions are taken from preload library, program is not linked with memory manager */
+    *(void**)&heap_get_stats = dlsym(RTLD_DEFAULT, "lwmem_get_stats");
+    *(void**)&heap_usable_size = dlsym(RTLD_DEFAULT, "lwmem_usable_size");
+    TEST_ASSERT(heap_get_stats != NULL && heap_usable_size != NULL);
+
+    /* Standard functions allocate from heap */
+    free(malloc(1));                            /* Heap is initialized on first use */
+    available = heap_available();
+    ptr = malloc(1000);
+    TEST_ASSERT(ptr != NULL && heap_available() < available);
+    TEST_ASSERT(malloc_usable_size(ptr) == heap_usable_size(ptr) && malloc_usable_size(ptr) >= 1000);
+    memset(ptr, 0x5A, 1000);
+    ptr = realloc(ptr, 4 << 20);
+    TEST_ASSERT(ptr != NULL && ptr[0] == 0x5A && ptr[999] == 0x5A);
+    free(ptr);
+    TEST_ASSERT(heap_available() == available);
+
+    ptr = calloc(1000, 1000);
+    TEST_ASSERT(ptr != NULL);
+    for (i = 0; i < 1000 * 1000; i += 1000) {
+        TEST_ASSERT(ptr[i] == 0);
+    }
+    free(ptr);
+    TEST_ASSERT(posix_memalign(&aligned, 4096, 100) == 0 && (uintptr_t)aligned % 4096 == 0);
+    free(aligned);
+    TEST_ASSERT(posix_memalign(&aligned, 3, 100) != 0);
+    aligned = aligned_alloc(256, 512);
+    TEST_ASSERT(aligned != NULL && (uintptr_t)aligned % 256 == 0);
+    free(aligned);
+    TEST_ASSERT(realloc(malloc(10), 0) == NULL);
+    free(NULL);
+
+    /* Threads and child process after fork use the same functions */
+    for (i = 0; i < THREAD_COUNT; ++i) {
+        TEST_ASSERT(pthread_create(&threads[i], NULL, test_thread, NULL) == 0);
+    }
+    pid = fork();
+    TEST_ASSERT(pid >= 0);
+    if (pid == 0) {
+        test_thread(NULL);
+        _exit(0);
+    }
+    for (i = 0; i < THREAD_COUNT; ++i) {
+        TEST_ASSERT(pthread_join(threads[i], NULL) == 0);
+    }
+    TEST_ASSERT(waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    return 0;
+}
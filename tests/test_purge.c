@@ -0,0 +1,139 @@
+/**
+ * \file            test_purge.c
+ * \brief           Returning memory of free blocks to operating system and accounting of clean bytes
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif /* _GNU_SOURCE */
+#include "test.h"
+#include "string.h"
+#include "sys/mman.h"
+#include "unistd.h"
+
+#define REGION_SIZE                     ((size_t)4 << 20)
+
+/**
+ * \brief           Get size of resident memory of range
+ * \param[in]       mem: Page aligned memory
+ * \param[in]       size: Size of memory in units of bytes
+ * \return          Resident size in units of bytes
+ */
+static size_t
+test_resident(void* const mem, const size_t size) {
+    static unsigned char vec[REGION_SIZE / 4096];
+    const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    size_t i, resident = 0;
+
+    TEST_ASSERT(size / page_size <= sizeof(vec));
+    TEST_ASSERT(mincore(mem, size, vec) == 0);
+    for (i = 0; i < size / page_size; ++i) {
+        resident += (vec[i] & 1) ? page_size : 0;
+    }
+    return resident;
+}
+
+/**
+ * \brief           Get number of clean bytes of heap
+ * \return          Clean bytes
+ */
+static size_t
+test_clean(void) {
+    lwmem_stats_t stats;
+
+    lwmem_get_stats(&stats);
+    TEST_ASSERT(stats.clean_bytes + stats.dirty_bytes == stats.mem_available_bytes);
+    return stats.clean_bytes;
+}
+
+int
+main(void) {
+    const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    lwmem_region_t region = {NULL, REGION_SIZE, 0};
+    unsigned char* ptr, *other;
+    size_t available, purged, clean, i;
+
+    region.start_addr = mmap(NULL, REGION_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    TEST_ASSERT(region.start_addr != MAP_FAILED);
+    TEST_ASSERT(lwmem_assignmem(&region, 1) == 1);
+    available = test_available();
+
+    /* Make all memory resident */
+    ptr = lwmem_malloc(REGION_SIZE / 2);
+    TEST_ASSERT(ptr != NULL);
+    memset(ptr, 0x5A, REGION_SIZE / 2);
+    lwmem_free(ptr);
+    TEST_ASSERT(test_clean() == 0);
+
+    /* Free block is purged after decay time only, which started when it was freed */
+    for (i = 1; i < LWMEM_PURGE_DECAY; ++i) {
+        TEST_ASSERT(lwmem_purge(0) == 0);
+    }
+    purged = lwmem_purge(0);
+    TEST_ASSERT(purged > REGION_SIZE - 4 * page_size);
+    TEST_ASSERT(test_clean() == purged);
+    TEST_ASSERT(lwmem_purge(1) == 0);           /* Clean pages are not released again */
+    TEST_ASSERT(test_resident(region.start_addr, REGION_SIZE) <= 4 * page_size);
+
+    /* Allocation from purged block keeps clean bytes of its remainder */
+    ptr = lwmem_malloc(100000);
+    TEST_ASSERT(ptr != NULL);
+    memset(ptr, 0x5A, 100000);
+    clean = test_clean();
+    TEST_ASSERT(clean < purged && clean >= purged - 100000 - 4 * page_size);
+    TEST_ASSERT(lwmem_purge(1) == 0);
+
+    /* Calloc from purged memory */
+    other = lwmem_calloc(1, 300000);
+    TEST_ASSERT(other != NULL);
+    for (i = 0; i < 300000; i += 1000) {
+        TEST_ASSERT(other[i] == 0);
+    }
+    TEST_ASSERT(lwmem_purge(1) == 0);
+
+    /* Expansion into purged block keeps clean bytes of its remainder */
+    clean = test_clean();
+    other = lwmem_realloc(other, 600000);
+    TEST_ASSERT(other != NULL);
+    TEST_ASSERT(test_clean() < clean && test_clean() >= clean - 600000 - 4 * page_size);
+    TEST_ASSERT(lwmem_purge(1) == 0);
+    TEST_CHECK_HEAP();
+
+    /* Freed dirty memory is purged again */
+    lwmem_free(ptr);
+    lwmem_free(other);
+    purged = lwmem_purge(1);
+    TEST_ASSERT(purged > 0 && purged <= 100000 + 600000 + 600000 / 2 + 4 * page_size);
+    TEST_ASSERT(test_clean() > REGION_SIZE - 8 * page_size);
+    TEST_CHECK_HEAP();
+    TEST_ASSERT(test_available() == available);
+    TEST_ASSERT(munmap(region.start_addr, REGION_SIZE) == 0);
+    return 0;
+}
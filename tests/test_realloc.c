@@ -0,0 +1,134 @@
+/**
+ * \file            test_realloc.c
+ * \brief           Growth reserve of reallocation and in-place resizing of blocks
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#include "test.h"
+#include "string.h"
+
+static unsigned char mem[1 << 16];
+
+/**
+ * \brief           Check that block reallocated to bigger size keeps growth reserve for next increments
+ */
+static void
+test_growth_reserve(void) {
+    const size_t available = test_available();
+    unsigned char* ptr, *other;
+    size_t usable, size, i;
+
+    ptr = lwmem_malloc(1000);
+    TEST_ASSERT(ptr != NULL);
+    memset(ptr, 0x5A, 1000);
+
+    /* Free memory follows block, it is expanded in place with reserve of half of new size */
+    TEST_ASSERT(lwmem_realloc(ptr, 2000) == ptr);
+    usable = lwmem_usable_size(ptr);
+    TEST_ASSERT(usable >= 2000 + 2000 / 2);
+    for (size = 2000; size <= usable; size += 100) {
+        TEST_ASSERT(lwmem_realloc(ptr, size) == ptr);
+        TEST_ASSERT(lwmem_usable_size(ptr) == usable);
+    }
+
+    /* Smaller size within reserve keeps block, while much smaller size trims it */
+    TEST_ASSERT(lwmem_realloc(ptr, 2100) == ptr);
+    TEST_ASSERT(lwmem_usable_size(ptr) == usable);
+    TEST_ASSERT(lwmem_realloc(ptr, 100) == ptr);
+    TEST_ASSERT(lwmem_usable_size(ptr) < 1000);
+    for (i = 0; i < 100; ++i) {
+        TEST_ASSERT(ptr[i] == 0x5A);
+    }
+    TEST_CHECK_HEAP();
+
+    /* Reserve is limited by free memory */
+    size = lwmem_usable_size(ptr) + test_available() - 256;
+    TEST_ASSERT(lwmem_realloc(ptr, size) == ptr);
+    TEST_ASSERT(lwmem_usable_size(ptr) >= size);
+    TEST_ASSERT(lwmem_realloc(ptr, 100) == ptr);
+
+    /* Allocated block follows, block is moved with its content */
+    other = lwmem_malloc(100);
+    TEST_ASSERT(other != NULL);
+    ptr = lwmem_realloc(ptr, 5000);
+    TEST_ASSERT(ptr != NULL && lwmem_usable_size(ptr) >= 5000 + 5000 / 2);
+    for (i = 0; i < 100; ++i) {
+        TEST_ASSERT(ptr[i] == 0x5A);
+    }
+    TEST_CHECK_HEAP();
+
+    lwmem_free(ptr);
+    lwmem_free(other);
+    TEST_CHECK_HEAP();
+    TEST_ASSERT(test_available() == available);
+}
+
+/**
+ * \brief           Check resizing of blocks without moving them
+ */
+static void
+test_in_place(void) {
+    const size_t available = test_available();
+    unsigned char* first, *second;
+
+    first = lwmem_malloc(100);
+    second = lwmem_malloc(100);
+    TEST_ASSERT(first != NULL && second != NULL);
+    memset(first, 0x11, 100);
+    memset(second, 0x22, 100);
+
+    TEST_ASSERT(!lwmem_expand_in_place(first, 1000));   /* Allocated block follows */
+    TEST_ASSERT(lwmem_usable_size(first) < 1000);
+    TEST_ASSERT(lwmem_expand_in_place(second, 3000));
+    TEST_ASSERT(lwmem_usable_size(second) >= 3000);
+    TEST_ASSERT(!lwmem_expand_in_place(second, sizeof(mem)));
+    TEST_ASSERT(lwmem_usable_size(second) >= 3000);
+    TEST_CHECK_HEAP();
+
+    TEST_ASSERT(lwmem_shrink_in_place(second, 10));
+    TEST_ASSERT(lwmem_usable_size(second) >= 10 && lwmem_usable_size(second) < 3000);
+    TEST_ASSERT(!lwmem_shrink_in_place(second, 3000));  /* Bigger than block */
+    TEST_ASSERT(first[99] == 0x11 && second[0] == 0x22 && second[9] == 0x22);
+    TEST_CHECK_HEAP();
+
+    lwmem_free(first);
+    lwmem_free(second);
+    TEST_CHECK_HEAP();
+    TEST_ASSERT(test_available() == available);
+}
+
+int
+main(void) {
+    const lwmem_region_t regions[] = {{mem, sizeof(mem), 0}};
+
+    TEST_ASSERT(lwmem_assignmem(regions, 1) == 1);
+    test_growth_reserve();
+    test_in_place();
+    return 0;
+}
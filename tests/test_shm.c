@@ -0,0 +1,160 @@
+/**
+ * \file            test_shm.c
+ * \brief           Shared memory heap mapped at different addresses and recovered after owner death
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#include "test.h"
+#include "string.h"
+#include "sys/mman.h"
+#include "sys/wait.h"
+#include "unistd.h"
+
+/* Source is included to check heap with its internal functions */
+#include "../src/lwmem/lwmem_shm.c"
+
+#define SEGMENT_SIZE                    ((size_t)1 << 20)
+
+/**
+ * \brief           Check list of free blocks and all blocks of segment
+ */
+#define TEST_CHECK_SHM(shm)             TEST_ASSERT(prv_shm_check_free_list(shm) && prv_shm_check_blocks(shm))
+
+/**
+ * \brief           Map segment from file
+ * \param[in]       fd: File descriptor
+ * \return          Segment start address
+ */
+static void*
+test_map(const int fd) {
+    void* const mem = mmap(NULL, SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    TEST_ASSERT(mem != MAP_FAILED);
+    return mem;
+}
+
+int
+main(void) {
+    FILE* const file = tmpfile();
+    lwmem_shm_t* shm, *shm2;
+    void* mem, *mem2, *ptr2, *ptrs[100];
+    char* root;
+    size_t available, i;
+    pid_t pid;
+    int fd, status;
+
+    TEST_ASSERT(file != NULL);
+    fd = fileno(file);
+    TEST_ASSERT(ftruncate(fd, (off_t)SEGMENT_SIZE) == 0);
+
+    /* Initialize segment and set root object */
+    mem = test_map(fd);
+    shm = lwmem_shm_init(mem, SEGMENT_SIZE);
+    TEST_ASSERT(shm != NULL);
+    root = lwmem_shm_malloc(shm, 100);
+    TEST_ASSERT(root != NULL);
+    strcpy(root, "root");
+    TEST_ASSERT(lwmem_shm_set_root(shm, root));
+    TEST_CHECK_SHM(shm);
+
+    /* Attach segment mapped at different address */
+    mem2 = test_map(fd);
+    TEST_ASSERT(mem2 != mem);
+    shm2 = lwmem_shm_attach(mem2);
+    TEST_ASSERT(shm2 != NULL);
+    TEST_ASSERT(strcmp(lwmem_shm_get_root(shm2), "root") == 0);
+    TEST_ASSERT(lwmem_shm_to_offset(shm2, lwmem_shm_get_root(shm2)) == lwmem_shm_to_offset(shm, root));
+    ptr2 = lwmem_shm_malloc(shm2, 5000);
+    TEST_ASSERT(ptr2 != NULL);
+    strcpy(ptr2, "second");
+    TEST_ASSERT(strcmp(lwmem_shm_from_offset(shm, lwmem_shm_to_offset(shm2, ptr2)), "second") == 0);
+    lwmem_shm_free(shm, lwmem_shm_from_offset(shm, lwmem_shm_to_offset(shm2, ptr2)));
+    for (i = 0; i < 100; ++i) {
+        ptrs[i] = lwmem_shm_malloc(i % 2 ? shm : shm2, i * 37 + 1);
+        TEST_ASSERT(ptrs[i] != NULL);
+    }
+    for (i = 0; i < 100; i += 2) {
+        lwmem_shm_free(shm, lwmem_shm_from_offset(shm, lwmem_shm_to_offset(shm2, ptrs[i])));
+    }
+    TEST_CHECK_SHM(shm);
+
+    /* Owner of mutex dies while holding it */
+    pid = fork();
+    TEST_ASSERT(pid >= 0);
+    if (pid == 0) {
+        lwmem_shm_t* const child = lwmem_shm_attach(test_map(fd));
+
+        _exit(child != NULL && prv_shm_lock(child) ? 0 : 1);
+    }
+    TEST_ASSERT(waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    ptrs[0] = lwmem_shm_malloc(shm, 10);       /* Free list is rebuilt and mutex made consistent */
+    TEST_ASSERT(ptrs[0] != NULL);
+    lwmem_shm_free(shm2, lwmem_shm_from_offset(shm2, lwmem_shm_to_offset(shm, ptrs[0])));
+    TEST_CHECK_SHM(shm);
+
+    /* Owner dies after it unlinked free block, before it updated available bytes */
+    available = shm->available;
+    pid = fork();
+    TEST_ASSERT(pid >= 0);
+    if (pid == 0) {
+        lwmem_shm_t* const child = lwmem_shm_attach(test_map(fd));
+
+        if (child == NULL || !prv_shm_lock(child)) {
+            _exit(1);
+        }
+        child->start_block.next = LWMEM_SHM_BLOCK(child, child->start_block.next)->next;
+        _exit(0);
+    }
+    TEST_ASSERT(waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    TEST_ASSERT(!prv_shm_check_free_list(shm));
+    ptrs[0] = lwmem_shm_malloc(shm, 10);
+    TEST_ASSERT(ptrs[0] != NULL);
+    TEST_CHECK_SHM(shm);
+    lwmem_shm_free(shm, ptrs[0]);
+    TEST_ASSERT(shm->available == available);   /* Unlinked block is free again */
+    TEST_CHECK_SHM(shm);
+
+    /* Recover heap after all processes unmapped segment */
+    TEST_ASSERT(munmap(mem, SEGMENT_SIZE) == 0);
+    TEST_ASSERT(munmap(mem2, SEGMENT_SIZE) == 0);
+    mem = test_map(fd);
+    shm = lwmem_shm_recover(mem, SEGMENT_SIZE);
+    TEST_ASSERT(shm != NULL);
+    TEST_ASSERT(strcmp(lwmem_shm_get_root(shm), "root") == 0);
+    TEST_ASSERT(lwmem_shm_malloc(shm, 1000) != NULL);
+    TEST_CHECK_SHM(shm);
+
+    /* Segment without valid heap is rejected */
+    memset(mem, 0x00, 64);
+    TEST_ASSERT(lwmem_shm_recover(mem, SEGMENT_SIZE) == NULL);
+
+    TEST_ASSERT(munmap(mem, SEGMENT_SIZE) == 0);
+    fclose(file);
+    return 0;
+}
@@ -0,0 +1,110 @@
+/**
+ * \file            test_snapshot.c
+ * \brief           Heap snapshot and restore round-trip
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#include "test.h"
+#include "string.h"
+
+#define PTR_COUNT                       40
+#define PTR_SIZE(i)                     ((size_t)50 + (size_t)(i) * 7)
+
+static unsigned char mem1[1 << 14], mem2[1 << 13];
+
+int
+main(void) {
+    lwmem_region_t regions[] = {{mem1 + 3, sizeof(mem1) - 3, 0}, {mem2, sizeof(mem2), 0}};
+    unsigned char* ptrs[PTR_COUNT];
+    size_t size, initial, available, i, k;
+    void* buf;
+
+    /* Regions must be sorted by address, first one is not aligned */
+    if ((void*)mem2 < (void*)mem1) {
+        const lwmem_region_t tmp = regions[0];
+        regions[0] = regions[1];
+        regions[1] = tmp;
+    }
+    TEST_ASSERT(lwmem_assignmem(regions, 2) == 2);
+    initial = test_available();
+    for (i = 0; i < PTR_COUNT; ++i) {
+        ptrs[i] = lwmem_malloc(PTR_SIZE(i));
+        TEST_ASSERT(ptrs[i] != NULL);
+        memset(ptrs[i], (int)i, PTR_SIZE(i));
+    }
+    for (i = 0; i < PTR_COUNT; i += 3) {
+        lwmem_free(ptrs[i]);
+        ptrs[i] = NULL;
+    }
+    TEST_CHECK_HEAP();
+
+    /* Snapshot */
+    size = lwmem_snapshot(NULL, 0);
+    TEST_ASSERT(size > 0);
+    buf = malloc(size);
+    TEST_ASSERT(buf != NULL);
+    TEST_ASSERT(lwmem_snapshot(buf, size - 1) == 0);
+    TEST_ASSERT(lwmem_snapshot(buf, size) == size);
+    available = test_available();
+
+    /* Modify heap and memory content */
+    for (i = 0; i < PTR_COUNT; ++i) {
+        if (ptrs[i] != NULL) {
+            memset(ptrs[i], 0xFF, 10);
+            if (i % 2) {
+                lwmem_free(ptrs[i]);
+            }
+        }
+    }
+    TEST_ASSERT(lwmem_malloc(3000) != NULL);
+    TEST_CHECK_HEAP();
+
+    /* Restore */
+    TEST_ASSERT(!lwmem_restore(buf, size - 1));
+    TEST_ASSERT(lwmem_restore(buf, size));
+    TEST_CHECK_HEAP();
+    TEST_ASSERT(test_available() == available);
+    for (i = 0; i < PTR_COUNT; ++i) {
+        if (ptrs[i] != NULL) {
+            TEST_ASSERT(lwmem_usable_size(ptrs[i]) >= PTR_SIZE(i));
+            for (k = 0; k < PTR_SIZE(i); ++k) {
+                TEST_ASSERT(ptrs[i][k] == (unsigned char)i);
+            }
+        }
+    }
+
+    /* Restored heap is usable */
+    for (i = 0; i < PTR_COUNT; ++i) {
+        lwmem_free(ptrs[i]);
+    }
+    TEST_CHECK_HEAP();
+    TEST_ASSERT(test_available() == initial);
+    free(buf);
+    return 0;
+}
@@ -0,0 +1,105 @@
+/**
+ * \file            test_stack.c
+ * \brief           Stack allocator marks and release in LIFO order
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#include "test.h"
+#include "stdint.h"
+#include "lwmem/lwmem_stack.h"
+
+#define STACK_ALIGN                     (sizeof(void *) > sizeof(double) ? sizeof(void *) : sizeof(double))
+
+static unsigned char mem[1 << 16];
+static unsigned char user_mem[1001];
+
+/**
+ * \brief           Push and release memory of stack
+ * \param[in]       stack: Stack to test
+ */
+static void
+test_stack(lwmem_stack_t* const stack) {
+    lwmem_stack_mark_t mark, mark2;
+    unsigned char* first, *second, *ptr;
+
+    mark = lwmem_stack_mark(stack);
+    first = lwmem_stack_push(stack, 3);
+    second = lwmem_stack_push(stack, 5);
+    TEST_ASSERT(first != NULL && second != NULL);
+    TEST_ASSERT((uintptr_t)first % STACK_ALIGN == 0 && (uintptr_t)second % STACK_ALIGN == 0);
+    TEST_ASSERT(second == first + STACK_ALIGN);
+
+    mark2 = lwmem_stack_mark(stack);
+    TEST_ASSERT(lwmem_stack_push(stack, 100000) == NULL);   /* Failed push keeps stack */
+    TEST_ASSERT(lwmem_stack_mark(stack) == mark2);
+    TEST_ASSERT(lwmem_stack_push(stack, 0) == NULL);
+    TEST_ASSERT(lwmem_stack_push(stack, 10) == second + STACK_ALIGN);
+
+    lwmem_stack_release(stack, mark2);
+    ptr = lwmem_stack_push(stack, 1);
+    TEST_ASSERT(ptr == second + STACK_ALIGN);
+    lwmem_stack_release(stack, mark);
+    TEST_ASSERT(lwmem_stack_push(stack, 1) == first);
+
+    /* Stack gets full and release to mark in the future is ignored */
+    lwmem_stack_release(stack, 0);
+    while (lwmem_stack_push(stack, 1) != NULL) {}
+    mark = lwmem_stack_mark(stack);
+    lwmem_stack_release(stack, mark + 1);
+    TEST_ASSERT(lwmem_stack_mark(stack) == mark);
+    lwmem_stack_release(stack, 0);
+    TEST_ASSERT(lwmem_stack_mark(stack) == 0);
+}
+
+int
+main(void) {
+    const lwmem_region_t regions[] = {{mem, sizeof(mem), 0}};
+    lwmem_stack_t* stack, user_stack;
+    size_t available;
+
+    TEST_ASSERT(lwmem_assignmem(regions, 1) == 1);
+    available = test_available();
+
+    /* Stack on heap memory */
+    stack = lwmem_stack_create(1000);
+    TEST_ASSERT(stack != NULL);
+    test_stack(stack);
+    TEST_CHECK_HEAP();
+    lwmem_stack_destroy(stack);
+    TEST_ASSERT(test_available() == available);
+
+    /* Stack on unaligned user memory */
+    TEST_ASSERT(!lwmem_stack_init(&user_stack, user_mem, 0));
+    TEST_ASSERT(lwmem_stack_init(&user_stack, user_mem + 1, sizeof(user_mem) - 1));
+    test_stack(&user_stack);
+    lwmem_stack_destroy(&user_stack);
+    TEST_ASSERT(lwmem_stack_mark(&user_stack) == 0);
+    TEST_ASSERT(test_available() == available);
+    return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * \file            test_stats.c
+ * \brief           Allocation counters summed from per-thread slots
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#include "test.h"
+#include "pthread.h"
+
+#define THREAD_COUNT                    20      /* More threads than counter slots */
+#define ITER_COUNT                      5000
+
+static unsigned char mem[1 << 20];
+
+/**
+ * \brief           Allocate, reallocate and free memory
+ * \param[in]       arg: Unused
+ * \return          `NULL`
+ */
+static void*
+test_thread(void* arg) {
+    size_t i;
+    void* ptr;
+
+    (void)arg;
+    for (i = 0; i < ITER_COUNT; ++i) {
+        ptr = lwmem_malloc(32 + i % 64);
+        TEST_ASSERT(ptr != NULL);
+        ptr = lwmem_realloc(ptr, 200 + i % 64);
+        TEST_ASSERT(ptr != NULL);
+        lwmem_free(ptr);
+    }
+    return NULL;
+}
+
+int
+main(void) {
+    const lwmem_region_t regions[] = {{mem, sizeof(mem), 0}};
+    pthread_t threads[THREAD_COUNT];
+    lwmem_stats_t stats;
+    size_t available, i;
+    void* ptr;
+
+    TEST_ASSERT(lwmem_assignmem(regions, 1) == 1);
+    available = test_available();
+    lwmem_get_stats(&stats);
+    TEST_ASSERT(stats.alloc_count == 0 && stats.free_count == 0);
+    TEST_ASSERT(stats.realloc_count == 0 && stats.failed_count == 0);
+
+    for (i = 0; i < THREAD_COUNT; ++i) {
+        TEST_ASSERT(pthread_create(&threads[i], NULL, test_thread, NULL) == 0);
+    }
+    for (i = 0; i < THREAD_COUNT; ++i) {
+        TEST_ASSERT(pthread_join(threads[i], NULL) == 0);
+    }
+
+    /* Failed allocation and reallocation, and calloc counted as allocation */
+    TEST_ASSERT(lwmem_malloc(sizeof(mem)) == NULL);
+    ptr = lwmem_calloc(3, 5);
+    TEST_ASSERT(ptr != NULL);
+    TEST_ASSERT(lwmem_realloc(ptr, sizeof(mem)) == NULL);
+    lwmem_free(ptr);
+
+    lwmem_get_stats(&stats);
+    TEST_ASSERT(stats.alloc_count == THREAD_COUNT * ITER_COUNT + 1);
+    TEST_ASSERT(stats.free_count == THREAD_COUNT * ITER_COUNT + 1);
+    TEST_ASSERT(stats.realloc_count == THREAD_COUNT * ITER_COUNT);
+    TEST_ASSERT(stats.failed_count == 2);
+    TEST_ASSERT(stats.mem_available_bytes == available);
+    TEST_CHECK_HEAP();
+    return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * \file            test_usable_size.c
+ * \brief           Usable size of blocks and allocation of at least requested size
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#include "test.h"
+#include "stdint.h"
+#include "string.h"
+
+static unsigned char mem[1 << 16];
+
+int
+main(void) {
+    const lwmem_region_t regions[] = {{mem, sizeof(mem), 0}};
+    unsigned char* ptrs[20];
+    size_t available, actual, i;
+
+    TEST_ASSERT(lwmem_assignmem(regions, 1) == 1);
+    available = test_available();
+    TEST_ASSERT(lwmem_usable_size(NULL) == 0);
+
+    /* Usable size covers requested size and complete usable size may be written */
+    for (i = 0; i < 20; ++i) {
+        ptrs[i] = lwmem_malloc(1 + i * 13);
+        TEST_ASSERT(ptrs[i] != NULL);
+        TEST_ASSERT(lwmem_usable_size(ptrs[i]) >= 1 + i * 13);
+        memset(ptrs[i], (int)i, lwmem_usable_size(ptrs[i]));
+    }
+    TEST_CHECK_HEAP();
+    for (i = 0; i < 20; ++i) {
+        TEST_ASSERT(ptrs[i][lwmem_usable_size(ptrs[i]) - 1] == (unsigned char)i);
+        lwmem_free(ptrs[i]);
+    }
+
+    /* Allocation reports actual size of block */
+    ptrs[0] = lwmem_malloc_at_least(10, &actual);
+    TEST_ASSERT(ptrs[0] != NULL);
+    TEST_ASSERT(actual >= 10 && actual == lwmem_usable_size(ptrs[0]));
+    ptrs[1] = lwmem_malloc_at_least(1000, NULL);
+    TEST_ASSERT(ptrs[1] != NULL && lwmem_usable_size(ptrs[1]) >= 1000);
+    TEST_ASSERT(lwmem_malloc_at_least(sizeof(mem), &actual) == NULL);
+    TEST_ASSERT(actual == 0);
+
+    /* Aligned block reports usable size from its aligned address */
+    ptrs[2] = lwmem_malloc_aligned(256, 100);
+    TEST_ASSERT(ptrs[2] != NULL && ((uintptr_t)ptrs[2] % 256) == 0);
+    TEST_ASSERT(lwmem_usable_size(ptrs[2]) >= 100);
+    memset(ptrs[2], 0xFF, lwmem_usable_size(ptrs[2]));
+    TEST_CHECK_HEAP();
+
+    for (i = 0; i < 3; ++i) {
+        lwmem_free(ptrs[i]);
+    }
+    TEST_CHECK_HEAP();
+    TEST_ASSERT(test_available() == available);
+    return 0;
+}
@@ -0,0 +1,152 @@
+/**
+ * \file            test_walk.c
+ * \brief           Walk through blocks of regions and consistency check of damaged heap
+ */
+
+/*
+ * Copyright (c) 2018 Tilen Majerle
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Lightweight dynamic memory manager library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ */
+#include "test.h"
+#include "string.h"
+
+/* Source is included to damage block meta data for consistency check */
+#include "../src/lwmem/lwmem.c"
+
+#define PTR_COUNT                       30
+
+static unsigned char mem1[1 << 14], mem2[1 << 13];
+
+/**
+ * \brief           Blocks reported by walk
+ */
+typedef struct {
+    size_t count;                               /*!< Number of reported blocks */
+    size_t limit;                               /*!< Stop walk after this number of blocks */
+    size_t free_bytes;                          /*!< Size of free blocks, including meta data */
+    size_t allocated;                           /*!< Number of allocated blocks */
+    void* last;                                 /*!< Last reported block, to check address order */
+    unsigned char* ptrs[PTR_COUNT];             /*!< Expected allocated blocks */
+    size_t regions[PTR_COUNT];                  /*!< Expected region indexes of allocated blocks */
+} walk_result_t;
+
+/**
+ * \brief           Walk callback, checks allocated blocks against expected ones
+ * \param[in]       info: Block information
+ * \param[in]       arg: Walk result
+ * \return          `1` to continue walk, `0` to stop it
+ */
+static unsigned char
+walk_fn(const lwmem_block_info_t* info, void* arg) {
+    walk_result_t* const res = arg;
+    size_t i;
+
+    TEST_ASSERT(res->last == NULL || (void*)info->ptr > res->last);
+    res->last = info->ptr;
+    if (info->allocated) {
+        for (i = 0; i < PTR_COUNT && res->ptrs[i] != info->ptr; ++i) {}
+        TEST_ASSERT(i < PTR_COUNT);
+        TEST_ASSERT(info->size == block_app_size(info->ptr));
+        TEST_ASSERT(info->region == res->regions[i]);
+        res->allocated++;
+    } else {
+        res->free_bytes += info->size + LWMEM_BLOCK_META_SIZE;
+    }
+    return ++res->count != res->limit;
+}
+
+int
+main(void) {
+    lwmem_region_t regions[] = {{mem1 + 3, sizeof(mem1) - 3, 0}, {mem2, sizeof(mem2), 0}};
+    walk_result_t res;
+    lwmem_block_t* block;
+    unsigned char* ptr;
+    void* next;
+    size_t i, allocated = 0;
+
+    /* Regions must be sorted by address */
+    if ((void*)mem2 < (void*)mem1) {
+        const lwmem_region_t tmp = regions[0];
+        regions[0] = regions[1];
+        regions[1] = tmp;
+    }
+    TEST_ASSERT(lwmem_check(LWMEM_CHECK_THOROUGH));  /* Empty memory manager */
+    TEST_ASSERT(lwmem_assignmem(regions, 2) == 2);
+
+    /* Fill first region, so that later blocks are in second one */
+    memset(&res, 0, sizeof(res));
+    for (i = 0; i < PTR_COUNT; ++i) {
+        ptr = lwmem_malloc(200 + i * 25);
+        TEST_ASSERT(ptr != NULL);
+        res.ptrs[i] = ptr;
+        res.regions[i] = ptr >= LWMEM_TO_BYTE_PTR(regions[1].start_addr) ? 1 : 0;
+    }
+    TEST_ASSERT(res.regions[0] == 0 && res.regions[PTR_COUNT - 1] == 1);
+    for (i = 0; i < PTR_COUNT; i += 3) {
+        lwmem_free(res.ptrs[i]);
+        res.ptrs[i] = NULL;
+    }
+    for (i = 0; i < PTR_COUNT; ++i) {
+        allocated += res.ptrs[i] != NULL;
+    }
+    TEST_CHECK_HEAP();
+
+    /* Complete walk reports all allocated blocks and all free memory */
+    TEST_ASSERT(lwmem_walk(walk_fn, &res) == res.count);
+    TEST_ASSERT(res.allocated == allocated);
+    TEST_ASSERT(res.free_bytes == test_available());
+
+    /* Walk is stopped by callback */
+    res.count = 0;
+    res.limit = 3;
+    res.last = NULL;
+    TEST_ASSERT(lwmem_walk(walk_fn, &res) == 3);
+    TEST_ASSERT(lwmem_walk(NULL, NULL) == 0);
+
+    /* Overwritten allocation marker is found by thorough check only */
+    block = LWMEM_GET_BLOCK_FROM_PTR(res.ptrs[1]);
+    next = block->next;
+    block->next = NULL;
+    TEST_ASSERT(lwmem_check(LWMEM_CHECK_FAST));
+    TEST_ASSERT(!lwmem_check(LWMEM_CHECK_THOROUGH));
+    block->next = next;
+    TEST_CHECK_HEAP();
+
+    /* Damaged size of free block overlaps following allocated block */
+    block = start_block.next;
+    TEST_ASSERT(block != NULL && LWMEM_TO_BYTE_PTR(block) < res.ptrs[1]);
+    block->size += LWMEM_ALIGN_NUM;
+    TEST_ASSERT(!lwmem_check(LWMEM_CHECK_FAST));
+    TEST_ASSERT(!lwmem_check(LWMEM_CHECK_THOROUGH));
+    block->size -= LWMEM_ALIGN_NUM;
+    TEST_CHECK_HEAP();
+
+    for (i = 0; i < PTR_COUNT; ++i) {
+        lwmem_free(res.ptrs[i]);
+    }
+    TEST_CHECK_HEAP();
+    return 0;
+}